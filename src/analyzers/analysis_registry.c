@@ -1,56 +1,106 @@
-#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "analysis_registry.h"
 #include "../../lib/sds/sds.h"
 #include "../fitness.h"
 
-#define analysis_fn(fn_label) static analysis_result_t check_ ## fn_label (sds input)
+#define analysis_fn(fn_label) static analysis_result_t check_ ## fn_label (sds input, const analysis_profile_t *profile)
 #define ANALYZER(fn_label) { .label = #fn_label, .popularity = 0.5, .fn = check_ ## fn_label }
 
-analysis_fn(HEX) {
-	int len = sdslen(input);
-	if (len % 2 != 0) {
-		return (analysis_result_t){ .probability = 0.0, .message = "Invalid string length" };
+// Periodicity analyzers
+#define IOC_MIN_LETTERS 20
+#define IOC_ENGLISH 0.060f     // at or above: monoalphabetic, transposed or plain
+#define IOC_RANDOM 0.045f      // below: polyalphabetic or random letters
+#define IOC_UNIFORM 0.0385f    // 1/26, uniformly random letters
+#define IOC_FULL_LETTERS 200   // letters before the IoC is trusted fully
+#define PERIOD_MIN_REPEATS 4   // a period must repeat this often to be measured
+#define PERIOD_MAX_LETTERS 256 // Vigenere keys
+#define PERIOD_MAX_BYTES 65536 // XOR keys, FFT autocorrelation keeps long keys cheap
+#define PERIOD_STRONG_LIFT 1.6f
+#define PERIOD_MAX_ENGLISH 0.35f // ENGLISH analyzer score: plaintext scores well above, Vigenere text well below
+#define PERIOD_FULL_COLUMN 30  // letters per key position before a period is trusted fully
+#define KASISKI_MAX_PERIOD 40
+#define KASISKI_SHARE 0.8f     // divisors of the period collect at least its votes, keep the largest close one
+#define KASISKI_MIN_VOTES 4    // repeats spaced by the period before it is reported
+#define KASISKI_FULL_VOTES 12  // repeats before the spacing is trusted fully
+#define MESSAGE_LEN 128
+
+// Class bitmask per byte, filled on first use
+static unsigned char byte_classes[256];
+static int byte_classes_ready = 0;
+
+static void init_byte_classes(void) {
+	for (int c = 0; c < 256; c++) {
+		int upper = c >= 'A' && c <= 'Z', lower = c >= 'a' && c <= 'z', digit = c >= '0' && c <= '9';
+		unsigned char mask = 0;
+		if (digit || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) mask |= 1 << CLASS_HEX;
+		if (upper || lower || digit || c == '+' || c == '/') mask |= 1 << CLASS_BASE64;
+		if (c == '=') mask |= 1 << CLASS_PAD;
+		if (upper || lower) mask |= 1 << CLASS_ALPHA;
+		if (digit) mask |= 1 << CLASS_DIGIT;
+		if (c >= 0x20 && c <= 0x7e) mask |= 1 << CLASS_PRINTABLE;
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n') mask |= 1 << CLASS_WHITESPACE;
+		byte_classes[c] = mask;
 	}
+	byte_classes_ready = 1;
+}
 
-	size_t hex_count = 0;
-	for (size_t i = 0; i < len; ++i) {
-		if (isxdigit((unsigned char)input[i])) {
-			hex_count++;
+void analysis_profile_build(sds input, analysis_profile_t *profile) {
+	if (!byte_classes_ready) init_byte_classes();
+
+	// The only pass over the input; class totals come from the 256 histogram bins
+	profile->len = sdslen(input);
+	byte_histogram(input, profile->len, profile->counts);
+
+	memset(profile->classes, 0, sizeof(profile->classes));
+	for (int c = 0; c < 256; c++) {
+		if (profile->counts[c] == 0) continue;
+		for (int k = 0; k < CLASS_COUNT; k++) {
+			if (byte_classes[c] & (1 << k)) profile->classes[k] += profile->counts[c];
 		}
 	}
+}
 
-	float prob = (float)hex_count / (float)(len);
+// Hex digest of the given number of digits
+static analysis_result_t check_digest(const analysis_profile_t *profile, size_t digits, const char *msg) {
+	if (profile->len != digits) {
+		return (analysis_result_t){ .probability = 0.0, .message = "Invalid length" };
+	}
+
+	float prob = (float)profile->classes[CLASS_HEX] / (float)(profile->len);
+	return (analysis_result_t){ .probability = prob, .message = msg };
+}
+
+analysis_fn(HEX) {
+	size_t len = profile->len;
+	if (len == 0 || len % 2 != 0) {
+		return (analysis_result_t){ .probability = 0.0, .message = "Invalid string length" };
+	}
+
+	float prob = (float)profile->classes[CLASS_HEX] / (float)(len);
 	const char *msg = "Possible hex encoding";
 	return (analysis_result_t){ .probability = prob, .message = msg };
 }
 
 analysis_fn(ENGLISH) {
-	int len = sdslen(input);
-	float prob = score_english_detailed(input, len);
+	// Bigram scoring is order-dependent, so this is the one analyzer that still reads the text
+	float prob = score_english_detailed(input, profile->len);
 	const char *msg = "Possible English text";
 	return (analysis_result_t){ .probability = prob, .message = msg };
 }
 
 analysis_fn(BASE64) {
-	int len = sdslen(input);
+	size_t len = profile->len;
 	// Check if the string length is a multiple of 4
-	if (len % 4 != 0) {
+	if (len == 0 || len % 4 != 0) {
 		return (analysis_result_t){ .probability = 0.0, .message = "Invalid string length" };
 	}
 
 	// Check for invalid characters
-	for (size_t i = 0; i < len; ++i) {
-		if (!isalnum((unsigned char)input[i]) && input[i] != '+' && input[i] != '/' && input[i] != '=') {
-			return (analysis_result_t){ .probability = 0.0, .message = "Invalid character" };
-		}
-	}
-
-	size_t base64ish = 0;
-	for (size_t i = 0; i < len; ++i) {
-		if (isalnum((unsigned char)input[i]) || input[i] == '+' || input[i] == '/' || input[i] == '=') {
-			base64ish++;
-		}
+	size_t base64ish = profile->classes[CLASS_BASE64] + profile->classes[CLASS_PAD];
+	if (base64ish != len) {
+		return (analysis_result_t){ .probability = 0.0, .message = "Invalid character" };
 	}
 
 	float prob = (float)base64ish / (float)(len);
@@ -59,39 +109,197 @@ analysis_fn(BASE64) {
 }
 
 analysis_fn(SHA256) {
-	int len = sdslen(input);
-	if (len != 64) {
-		return (analysis_result_t){ .probability = 0.0, .message = "Invalid length" };
+	return check_digest(profile, 64, "Possible SHA-256 hash (crack with -t C)");
+}
+
+analysis_fn(SHA1) {
+	return check_digest(profile, 40, "Possible SHA-1 hash (crack with -t C)");
+}
+
+analysis_fn(MD5) {
+	return check_digest(profile, 32, "Possible MD5 hash (crack with -t C)");
+}
+
+// Letters of the input as 0-25, in order
+static unsigned char *letter_stream(sds input, size_t *n) {
+	size_t len = sdslen(input);
+	unsigned char *letters = malloc(len > 0 ? len : 1);
+	*n = 0;
+	if (!letters) return NULL;
+	for (size_t i = 0; i < len; i++) {
+		unsigned char c = input[i];
+		if (c >= 'a' && c <= 'z') letters[(*n)++] = c - 'a';
+		else if (c >= 'A' && c <= 'Z') letters[(*n)++] = c - 'A';
 	}
+	return letters;
+}
 
-	size_t hex_count = 0;
-	for (size_t i = 0; i < len; ++i) {
-		if (isxdigit((unsigned char)input[i])) {
-			hex_count++;
-		}
+// Lift above the median shift mapped to 0-1
+static float lift_probability(float lift) {
+	float prob = (lift - 1.0f) / (PERIOD_STRONG_LIFT - 1.0f);
+	return prob < 0.0f ? 0.0f : prob > 1.0f ? 1.0f : prob;
+}
+
+// Evidence gathered against what is needed to trust it fully
+static float evidence_weight(int seen, int full) {
+	return seen >= full ? 1.0f : (float)seen / full;
+}
+
+// Case-folded letter index of coincidence from the profile, with the letter count
+static float profile_ioc(const analysis_profile_t *profile, int *total) {
+	int counts[26];
+	*total = 0;
+	for (int c = 0; c < 26; c++) {
+		counts[c] = profile->counts['a' + c] + profile->counts['A' + c];
+		*total += counts[c];
 	}
+	return *total > 1 ? index_of_coincidence(counts, *total) : 0.0f;
+}
 
-	float prob = (float)hex_count / (float)(len);
-	const char *msg = "Possible SHA-256 hash";
-	return (analysis_result_t){ .probability = prob, .message = msg };
+// Messages carrying numbers live in per-analyzer buffers, valid until that analyzer runs again
+analysis_fn(IOC) {
+	int total;
+	float ioc = profile_ioc(profile, &total);
+	if (total < IOC_MIN_LETTERS) {
+		return (analysis_result_t){ .probability = 0.0, .message = "Too few letters" };
+	}
+
+	static char msg[MESSAGE_LEN];
+	const char *kind = ioc >= IOC_ENGLISH ? "monoalphabetic, transposed or plain" :
+		ioc >= IOC_RANDOM ? "polyalphabetic" : "polyalphabetic with a long key, or random";
+	snprintf(msg, sizeof(msg), "Letter index of coincidence %.4f (%s)", ioc, kind);
+
+	// The measurement is as sure as its letter count. Polyalphabetic text sits between English and
+	// uniform letters: the hint is full down to IOC_RANDOM, fading out towards IOC_UNIFORM where
+	// random data and base encodings land too
+	float confidence = evidence_weight(total, IOC_FULL_LETTERS);
+	float poly = ioc >= IOC_ENGLISH ? 0.0f :
+		ioc >= IOC_RANDOM ? (IOC_ENGLISH - ioc) / (IOC_ENGLISH - IOC_RANDOM) :
+		(ioc - IOC_UNIFORM) / (IOC_RANDOM - IOC_UNIFORM);
+	if (poly < 0.0f) poly = 0.0f;
+	if (poly > 1.0f) poly = 1.0f;
+
+	return (analysis_result_t){
+		.probability = confidence,
+		.message = msg,
+		.solver = ioc < IOC_ENGLISH ? "VIGENERE_CRACK" : NULL,
+		.hint = poly * confidence
+	};
 }
 
-analysis_fn(MD5) {
-	int len = sdslen(input);
-	if (len != 32) {
-		return (analysis_result_t){ .probability = 0.0, .message = "Invalid length" };
+// Letter periods only mean a key when the letters are polyalphabetic: monoalphabetic text keeps
+// English's IoC, and short plaintext with a flat spread still reads as English
+static int letters_polyalphabetic(sds input, const analysis_profile_t *profile) {
+	int total;
+	if (profile_ioc(profile, &total) >= IOC_ENGLISH || total < IOC_MIN_LETTERS) return 0;
+	return score_english_detailed(input, profile->len) < PERIOD_MAX_ENGLISH;
+}
+
+analysis_fn(VIGENERE_PERIOD) {
+	if (!letters_polyalphabetic(input, profile)) {
+		return (analysis_result_t){ .probability = 0.0, .message = "Letters are not polyalphabetic" };
+	}
+
+	size_t n;
+	unsigned char *letters = letter_stream(input, &n);
+	int max_period = n / PERIOD_MIN_REPEATS;
+	if (max_period > PERIOD_MAX_LETTERS) max_period = PERIOD_MAX_LETTERS;
+
+	float lift;
+	int period = letters ? coincidence_period(letters, n, max_period, &lift) : 0;
+	free(letters);
+	if (!period) {
+		return (analysis_result_t){ .probability = 0.0, .message = "No letter period" };
+	}
+
+	static char msg[MESSAGE_LEN];
+	snprintf(msg, sizeof(msg), "Likely Vigenere period %d (letter coincidences %.2fx the other shifts)", period, lift);
+	float prob = lift_probability(lift) * evidence_weight(n / period, PERIOD_FULL_COLUMN);
+	return (analysis_result_t){
+		.probability = prob,
+		.message = msg,
+		.solver = "VIGENERE_CRACK",
+		.hint = prob,
+		.period = period
+	};
+}
+
+analysis_fn(XOR_PERIOD) {
+	int max_period = profile->len / PERIOD_MIN_REPEATS;
+	if (max_period > PERIOD_MAX_BYTES) max_period = PERIOD_MAX_BYTES;
+
+	float lift;
+	int period = hamming_period((const unsigned char *)input, profile->len, max_period, &lift);
+	if (!period) {
+		return (analysis_result_t){ .probability = 0.0, .message = "No byte period" };
+	}
+
+	static char msg[MESSAGE_LEN];
+	snprintf(msg, sizeof(msg), "Likely repeating-key XOR period %d (bit agreement %.2fx the other shifts)", period, lift);
+	float prob = lift_probability(lift);
+	return (analysis_result_t){
+		.probability = prob,
+		.message = msg,
+		.solver = "XOR",
+		.hint = prob,
+		.period = period
+	};
+}
+
+analysis_fn(KASISKI) {
+	if (!letters_polyalphabetic(input, profile)) {
+		return (analysis_result_t){ .probability = 0.0, .message = "Letters are not polyalphabetic" };
 	}
 
-	size_t hex_count = 0;
-	for (size_t i = 0; i < len; ++i) {
-		if (isxdigit((unsigned char)input[i])) {
-			hex_count++;
+	size_t n;
+	unsigned char *letters = letter_stream(input, &n);
+	int max_period = n / PERIOD_MIN_REPEATS;
+	if (max_period > KASISKI_MAX_PERIOD) max_period = KASISKI_MAX_PERIOD;
+
+	int votes[KASISKI_MAX_PERIOD + 1] = {0};
+	int repeats = 0;
+	if (letters && max_period >= 2) {
+		kasiski_votes(letters, n, max_period, votes);
+		// Repeated trigrams in total, what the votes are a share of
+		int *seen = calloc(26 * 26 * 26, sizeof(int));
+		for (size_t i = 0; seen && i + 2 < n; i++) {
+			int tri = (letters[i] * 26 + letters[i + 1]) * 26 + letters[i + 2];
+			if (seen[tri]++) repeats++;
 		}
+		free(seen);
 	}
+	free(letters);
 
-	float prob = (float)hex_count / (float)(len);
-	const char *msg = "Possible MD5 hash";
-	return (analysis_result_t){ .probability = prob, .message = msg };
+	int max_votes = 0;
+	for (int p = 2; p <= max_period; p++) {
+		if (votes[p] > max_votes) max_votes = votes[p];
+	}
+	int period = 0;
+	for (int p = max_period; p >= 2 && !period; p--) {
+		if (max_votes > 0 && votes[p] >= KASISKI_SHARE * max_votes) period = p;
+	}
+	if (!period || repeats == 0) {
+		return (analysis_result_t){ .probability = 0.0, .message = "No repeated trigrams" };
+	}
+
+	static char msg[MESSAGE_LEN];
+	snprintf(msg, sizeof(msg), "Repeated trigrams spaced by multiples of %d (%d of %d repeats)", period, votes[period], repeats);
+	if (votes[period] < KASISKI_MIN_VOTES) {
+		return (analysis_result_t){ .probability = 0.0, .message = msg };
+	}
+
+	// A 1/period share of the spacings divides by chance, count only the excess
+	float chance = 1.0f / period;
+	float share = ((float)votes[period] / repeats - chance) / (1.0f - chance);
+	if (share < 0.0f) share = 0.0f;
+	float prob = share * evidence_weight(votes[period], KASISKI_FULL_VOTES);
+	return (analysis_result_t){
+		.probability = prob,
+		.message = msg,
+		.solver = "VIGENERE_CRACK",
+		.hint = prob,
+		.period = period
+	};
 }
 
 // Ordered by popularity/commonness
@@ -100,7 +308,41 @@ analyzer_t analyzers[] = {
 	ANALYZER(HEX),
 	ANALYZER(BASE64),
 	ANALYZER(SHA256),
+	ANALYZER(SHA1),
 	ANALYZER(MD5),
+	ANALYZER(IOC),
+	ANALYZER(VIGENERE_PERIOD),
+	ANALYZER(XOR_PERIOD),
+	ANALYZER(KASISKI),
 };
 
 size_t analyzers_count = sizeof(analyzers) / sizeof(analyzer_t);
+
+analyzer_t *analysis_find(const char *label) {
+	for (size_t i = 0; i < analyzers_count; i++) {
+		if (strcmp(analyzers[i].label, label) == 0) return &analyzers[i];
+	}
+	return NULL;
+}
+
+size_t analysis_suggest(sds input, float min_probability, analysis_result_t *out, size_t max) {
+	analysis_profile_t profile;
+	analysis_profile_build(input, &profile);
+
+	size_t count = 0;
+	for (size_t i = 0; i < analyzers_count; i++) {
+		analysis_result_t result = analyzers[i].fn(input, &profile);
+		// The reported probability is how sure the measurement is, the hint how strongly it points at the solver
+		if (!result.solver || result.hint < min_probability) continue;
+
+		if (count == max && (max == 0 || out[max - 1].hint >= result.hint)) continue;
+
+		size_t j = count < max ? count++ : max - 1;
+		while (j > 0 && out[j - 1].hint < result.hint) {
+			out[j] = out[j - 1];
+			j--;
+		}
+		out[j] = result;
+	}
+	return count;
+}
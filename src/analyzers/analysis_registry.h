@@ -6,18 +6,51 @@
 typedef struct {
 	float probability;
 	const char *message;
+
+	// Engine-readable findings: the keyed solver the result points at, how strongly (0-1), and its key period (0 if none)
+	const char *solver;
+	float hint;
+	int period;
 } analysis_result_t;
 
+// Locale-independent byte classes, counted once per input for every analyzer
+enum {
+	CLASS_HEX,        // 0-9 a-f A-F
+	CLASS_BASE64,     // A-Z a-z 0-9 + /
+	CLASS_PAD,        // =
+	CLASS_ALPHA,      // A-Z a-z
+	CLASS_DIGIT,      // 0-9
+	CLASS_PRINTABLE,  // 0x20-0x7e
+	CLASS_WHITESPACE, // space \t \r \n
+	CLASS_COUNT
+};
+
+// One pass over the input: byte histogram, per-class totals and length
+typedef struct {
+	size_t len;
+	int counts[256];
+	int classes[CLASS_COUNT];
+} analysis_profile_t;
+
+void analysis_profile_build(sds input, analysis_profile_t *profile);
+
 typedef struct {
 	const char *label;
 
 	// 1 = popular, 0.75 = common, 0.5 = uncommon, 0.25 = rare, 0 = special
 	float popularity;
 	
-	analysis_result_t (*fn)(sds input);
+	analysis_result_t (*fn)(sds input, const analysis_profile_t *profile);
 } analyzer_t;
 
 extern analyzer_t analyzers[];
 extern size_t analyzers_count;
 
+// Analyzer by label, NULL when unknown; resolve once and call fn against a prebuilt profile
+analyzer_t *analysis_find(const char *label);
+
+// Results that name a solver with a hint of at least min_probability, strongest first, for the engine to try those first.
+// Returns how many were written (up to max).
+size_t analysis_suggest(sds input, float min_probability, analysis_result_t *out, size_t max);
+
 #endif // ANALYSIS_REGISTRY_H
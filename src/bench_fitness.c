@@ -0,0 +1,108 @@
+// English scoring benchmark: the fused single-pass score_english_detailed against the separate
+// bigram/casing/frequency scans it replaced. Checks both give identical scores on every sample first.
+// Usage: bench_fitness [quadgram model]
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fitness.h"
+#include "quadgram.h"
+
+#define BENCH_SAMPLES 512
+#define BENCH_MAX_LEN 1024
+#define BENCH_MIN_SECONDS 1.0
+
+static const char * ENGLISH_SAMPLE =
+    "It was the best of times, it was the worst of times. It was the age of wisdom! Was it the age of "
+    "foolishness? We had everything before us, we had nothing before us, we were all going direct to "
+    "Heaven, we were all going direct the other way. In short, the period was so far like the present "
+    "period, that some of its noisiest authorities insisted on its being received, for good or for evil, "
+    "in the superlative degree of comparison only. ";
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Mix of what the solver sees: English, shifted English, random letters, base64-like text and raw bytes
+static void fill_sample(int kind, char * out, size_t len) {
+    static const char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t english_len = strlen(ENGLISH_SAMPLE);
+    size_t start = next_random() % english_len;
+    for (size_t i = 0; i < len; i++) {
+        char c = ENGLISH_SAMPLE[(start + i) % english_len];
+        switch (kind) {
+        case 0: out[i] = c; break;
+        case 1: out[i] = (c >= 'a' && c <= 'z') ? (char)('a' + (c - 'a' + 13) % 26) : c; break;
+        case 2: out[i] = (next_random() % 6 == 0) ? ' ' : (char)('a' + next_random() % 26); break;
+        case 3: out[i] = BASE64[next_random() % 64]; break;
+        default: out[i] = (char)(next_random() & 0xFF); break;
+        }
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, & ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Throughput of one scorer over all samples, in MB/s
+static double bench(float (*score)(const char *, size_t), char ** samples, const size_t * lens, size_t bytes, float * sink) {
+    int rounds = 0;
+    double start = now_seconds(), elapsed;
+    do {
+        for (int s = 0; s < BENCH_SAMPLES; s++) * sink += score(samples[s], lens[s]);
+        rounds++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return (double) bytes * rounds / elapsed / 1e6;
+}
+
+int main(int argc, char * argv[]) {
+    quadgram_model_t * model = NULL;
+    if (argc > 1) {
+        model = quadgram_model_open(argv[1]);
+        if (!model) return 1;
+        quadgram_model_use(model);
+    }
+
+    char * samples[BENCH_SAMPLES];
+    size_t lens[BENCH_SAMPLES];
+    size_t bytes = 0;
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+        lens[s] = next_random() % BENCH_MAX_LEN;
+        samples[s] = malloc(lens[s] + 1);
+        fill_sample(s % 5, samples[s], lens[s]);
+        samples[s][lens[s]] = '\0';
+        bytes += lens[s];
+    }
+
+    int mismatches = 0;
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+        float fused = score_english_detailed(samples[s], lens[s]);
+        float passes = score_english_detailed_passes(samples[s], lens[s]);
+        if (memcmp( & fused, & passes, sizeof(float)) != 0) {
+            if (mismatches++ < 5) printf("MISMATCH sample %d (kind %d, %zu bytes): fused %.9g, passes %.9g\n", s, s % 5, lens[s], fused, passes);
+        }
+    }
+
+    float sink = 0.0f;
+    double passes = bench(score_english_detailed_passes, samples, lens, bytes, & sink);
+    double fused = bench(score_english_detailed, samples, lens, bytes, & sink);
+
+    printf("score_english_detailed (%s, %d samples, %zu bytes)\n", model ? "quadgram model" : "bigram list", BENCH_SAMPLES, bytes);
+    printf("  three passes: %8.1f MB/s\n", passes);
+    printf("  fused:        %8.1f MB/s (%.2fx)\n", fused, fused / passes);
+    printf("  scores: %s\n", mismatches ? "MISMATCH" : "identical");
+
+    for (int s = 0; s < BENCH_SAMPLES; s++) free(samples[s]);
+    quadgram_model_close(model);
+    return mismatches != 0 || sink < 0.0f;
+}
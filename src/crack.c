@@ -0,0 +1,601 @@
+#include "crack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <limits.h>
+#include <stdatomic.h>
+
+#include "hashes.h"
+#include "utils.h"
+
+typedef struct {
+    unsigned char digest[HASH_MAX_DIGEST];
+    const char * hex;
+    size_t hex_len;
+    atomic_int found; // claimed by the first worker to hit it
+} crack_target_t;
+
+// Targets of one algorithm, sorted by digest for bsearch
+typedef struct {
+    const hash_algo_t * algo;
+    crack_target_t * targets;
+    int count;
+} crack_group_t;
+
+typedef struct {
+    const keychain_t * keychain;
+    key_view_t * rules;
+    int rule_count;
+    crack_group_t * groups;
+    int group_count;
+    atomic_int remaining; // digests not yet found, read by every worker to stop early
+    size_t * tested; // candidates hashed per task
+} crack_job_t;
+
+// Digests are zero padded to HASH_MAX_DIGEST, so every algorithm compares the same way
+static int digest_compare(const void * a, const void * b) {
+    return memcmp(((const crack_target_t *) a) -> digest, ((const crack_target_t *) b) -> digest, HASH_MAX_DIGEST);
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, & ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Bytes of operands each rule op consumes
+static int rule_op_args(char op) {
+    switch (op) {
+    case ':': case 'l': case 'u': case 'c': case 'C': case 't':
+    case 'r': case 'd': case 'f': case '[': case ']':
+        return 0;
+    case '$': case '^':
+        return 1;
+    case 's':
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+static int rule_valid(key_view_t rule) {
+    for (size_t i = 0; i < rule.len; i++) {
+        int args = rule_op_args(rule.data[i]);
+        if (args < 0 || i + args >= rule.len) return 0;
+        i += args;
+    }
+    return 1;
+}
+
+// Applies a validated rule to word; returns the candidate length or -1 if it outgrew CRACK_MAX_CANDIDATE
+static int rule_apply(key_view_t rule, const char * word, size_t word_len, char * out) {
+    if (word_len > CRACK_MAX_CANDIDATE) return -1;
+    memcpy(out, word, word_len);
+    size_t n = word_len;
+
+    for (size_t i = 0; i < rule.len; i++) {
+        char op = rule.data[i];
+        switch (op) {
+        case 'l':
+            for (size_t j = 0; j < n; j++) out[j] = tolower((unsigned char) out[j]);
+            break;
+        case 'u':
+            for (size_t j = 0; j < n; j++) out[j] = toupper((unsigned char) out[j]);
+            break;
+        case 'c':
+        case 'C':
+            for (size_t j = 0; j < n; j++) {
+                int upper = (j == 0) == (op == 'c');
+                out[j] = upper ? toupper((unsigned char) out[j]) : tolower((unsigned char) out[j]);
+            }
+            break;
+        case 't':
+            for (size_t j = 0; j < n; j++) {
+                unsigned char ch = out[j];
+                out[j] = isupper(ch) ? tolower(ch) : toupper(ch);
+            }
+            break;
+        case 'r':
+            for (size_t j = 0; j < n / 2; j++) {
+                char tmp = out[j];
+                out[j] = out[n - 1 - j];
+                out[n - 1 - j] = tmp;
+            }
+            break;
+        case 'd':
+            if (n * 2 > CRACK_MAX_CANDIDATE) return -1;
+            memcpy(out + n, out, n);
+            n *= 2;
+            break;
+        case 'f':
+            if (n * 2 > CRACK_MAX_CANDIDATE) return -1;
+            for (size_t j = 0; j < n; j++) out[n + j] = out[n - 1 - j];
+            n *= 2;
+            break;
+        case '[':
+            if (n > 0) memmove(out, out + 1, --n);
+            break;
+        case ']':
+            if (n > 0) n--;
+            break;
+        case '$':
+            if (n == CRACK_MAX_CANDIDATE) return -1;
+            out[n++] = rule.data[++i];
+            break;
+        case '^':
+            if (n == CRACK_MAX_CANDIDATE) return -1;
+            memmove(out + 1, out, n++);
+            out[0] = rule.data[++i];
+            break;
+        case 's': {
+            char from = rule.data[++i], to = rule.data[++i];
+            for (size_t j = 0; j < n; j++) {
+                if (out[j] == from) out[j] = to;
+            }
+            break;
+        }
+        default: // ':'
+            break;
+        }
+    }
+    return (int) n;
+}
+
+// Hashes a batch of candidates and reports any target they hit
+static void crack_flush(crack_job_t * job, crack_group_t * group, char cand[][CRACK_MAX_CANDIDATE], size_t * lens, int count) {
+    const unsigned char * msgs[HASH_LANES] = { 0 };
+    unsigned char digests[HASH_LANES * HASH_MAX_DIGEST];
+    for (int l = 0; l < count; l++) msgs[l] = (const unsigned char *) cand[l];
+    hash_lanes(group -> algo, msgs, lens, count, digests);
+
+    size_t dlen = group -> algo -> digest_len;
+    for (int l = 0; l < count; l++) {
+        crack_target_t key = { { 0 } };
+        memcpy(key.digest, digests + l * dlen, dlen);
+        crack_target_t * hit = bsearch( & key, group -> targets, group -> count, sizeof(crack_target_t), digest_compare);
+        if (!hit) continue;
+
+        // One worker claims each digest; a single printf call is not interleaved with others
+        if (atomic_exchange( & hit -> found, 1) == 0) {
+            atomic_fetch_sub( & job -> remaining, 1);
+            printf("[FOUND] %s %.*s : %.*s\n", group -> algo -> name, (int) hit -> hex_len, hit -> hex, (int) lens[l], cand[l]);
+            fflush(stdout);
+        }
+    }
+}
+
+static void crack_task(int task, void * ctx) {
+    crack_job_t * job = ctx;
+    const keychain_t * keychain = job -> keychain;
+    size_t start = (size_t) task * CRACK_CHUNK;
+    size_t end = start + CRACK_CHUNK;
+    if (end > (size_t) keychain -> len) end = keychain -> len;
+
+    char cand[HASH_LANES][CRACK_MAX_CANDIDATE];
+    size_t lens[HASH_LANES];
+    size_t tested = 0;
+
+    for (int g = 0; g < job -> group_count; g++) {
+        crack_group_t * group = & job -> groups[g];
+        int filled = 0;
+
+        for (size_t k = start; k < end && atomic_load_explicit( & job -> remaining, memory_order_relaxed) > 0; k++) {
+            key_view_t word = keychain -> keys[k];
+            for (int r = 0; r < job -> rule_count; r++) {
+                int n = rule_apply(job -> rules[r], word.data, word.len, cand[filled]);
+                if (n < 0) continue;
+                lens[filled++] = n;
+                if (filled == HASH_LANES) {
+                    crack_flush(job, group, cand, lens, filled);
+                    tested += filled;
+                    filled = 0;
+                }
+            }
+        }
+        if (filled > 0) {
+            crack_flush(job, group, cand, lens, filled);
+            tested += filled;
+        }
+    }
+
+    job -> tested[task] = tested;
+}
+
+// Splits rules on whitespace into views over the argument string
+static int parse_rules(const char * rules, key_view_t ** out) {
+    int count = 0;
+    *out = NULL;
+    const char * p = rules;
+    while (*p) {
+        while (*p && isspace((unsigned char) *p)) p++;
+        if (!*p) break;
+        const char * start = p;
+        while (*p && !isspace((unsigned char) *p)) p++;
+
+        key_view_t rule = { start, (size_t)(p - start) };
+        if (!rule_valid(rule)) {
+            fprintf(stderr, "ERROR: Invalid rule: %.*s\n", (int) rule.len, rule.data);
+            free(*out);
+            return -1;
+        }
+        key_view_t * grown = realloc(*out, sizeof(key_view_t) * (count + 1));
+        if (!grown) {
+            fprintf(stderr, "ERROR: Out of memory parsing rules\n");
+            free(*out);
+            return -1;
+        }
+        *out = grown;
+        (*out)[count++] = rule;
+    }
+    return count;
+}
+
+int crack(sds input, const keychain_t * keychain, const char * rules) {
+    if (keychain -> len == 0) {
+        fprintf(stderr, "ERROR: Cracking needs a wordlist (-k or -K).\n");
+        return -1;
+    }
+
+    key_view_t * rule_views;
+    int rule_count = parse_rules(rules ? rules : CRACK_DEFAULT_RULES, & rule_views);
+    if (rule_count <= 0) {
+        if (rule_count == 0) fprintf(stderr, "ERROR: No rules given.\n");
+        return -1;
+    }
+
+    // Group the digests by algorithm, which is implied by their length
+    crack_group_t groups[HASH_ALGO_COUNT];
+    int group_count = 0, total = 0;
+    size_t sep = 0;
+    for (size_t i = 0; i < sdslen(input); i = sep + 1) {
+        while (i < sdslen(input) && isspace((unsigned char) input[i])) i++;
+        if (i >= sdslen(input)) break;
+        sep = i;
+        while (sep < sdslen(input) && !isspace((unsigned char) input[sep])) sep++;
+
+        const char * hex = input + i;
+        size_t hex_len = sep - i;
+        const hash_algo_t * algo = hash_algo_for_hex(hex_len);
+        unsigned char digest[HASH_MAX_DIGEST] = { 0 };
+        if (!algo || hex_to_digest(hex, algo -> digest_len, digest) != 0) {
+            printf("[INFO] Skipping %.*s: not an MD5, SHA-1 or SHA-256 hex digest\n", (int) hex_len, hex);
+            continue;
+        }
+
+        crack_group_t * group = NULL;
+        for (int g = 0; g < group_count; g++) {
+            if (groups[g].algo == algo) group = & groups[g];
+        }
+        if (!group) {
+            group = & groups[group_count++];
+            *group = (crack_group_t){ .algo = algo };
+        }
+        crack_target_t * targets = realloc(group -> targets, sizeof(crack_target_t) * (group -> count + 1));
+        if (!targets) {
+            fprintf(stderr, "ERROR: Out of memory reading digests\n");
+            total = -1;
+            break;
+        }
+        group -> targets = targets;
+        crack_target_t * target = & group -> targets[group -> count++];
+        memcpy(target -> digest, digest, HASH_MAX_DIGEST);
+        target -> hex = hex;
+        target -> hex_len = hex_len;
+        atomic_init( & target -> found, 0);
+        total++;
+    }
+
+    if (total <= 0) {
+        if (total == 0) fprintf(stderr, "ERROR: No hex digests to crack.\n");
+        for (int g = 0; g < group_count; g++) free(groups[g].targets);
+        free(rule_views);
+        return -1;
+    }
+
+    for (int g = 0; g < group_count; g++) {
+        qsort(groups[g].targets, groups[g].count, sizeof(crack_target_t), digest_compare);
+    }
+
+    int tasks = (keychain -> len + CRACK_CHUNK - 1) / CRACK_CHUNK;
+    crack_job_t job = {
+        .keychain = keychain,
+        .rules = rule_views,
+        .rule_count = rule_count,
+        .groups = groups,
+        .group_count = group_count,
+        .tested = calloc(tasks, sizeof(size_t))
+    };
+    atomic_init( & job.remaining, total);
+    if (!job.tested) {
+        fprintf(stderr, "ERROR: Out of memory\n");
+        for (int g = 0; g < group_count; g++) free(groups[g].targets);
+        free(rule_views);
+        return -1;
+    }
+
+    printf("[INFO] Cracking %d digest(s) with %d key(s) x %d rule(s)\n", total, keychain -> len, rule_count);
+    double start = monotonic_seconds();
+    parallel_for(tasks, crack_task, & job);
+    double elapsed = monotonic_seconds() - start;
+
+    size_t tested = 0;
+    for (int t = 0; t < tasks; t++) tested += job.tested[t];
+    int workers = cpu_count() < tasks ? cpu_count() : tasks;
+    double rate = elapsed > 0 ? tested / elapsed : 0;
+    printf("[INFO] %zu candidates in %.2fs: %.0f H/s total, %.0f H/s per core (%d cores)\n",
+        tested, elapsed, rate, rate / workers, workers);
+    int remaining = atomic_load( & job.remaining);
+    printf("[INFO] Cracked %d of %d digest(s)\n", total - remaining, total);
+
+    for (int g = 0; g < group_count; g++) free(groups[g].targets);
+    free(job.tested);
+    free(rule_views);
+    return remaining;
+}
+
+// ==========================================
+// Precomputed digest index
+// ==========================================
+
+// File layout, native byte order: header, wordlist path padded to 16 bytes, then
+// counts[0] MD5 entries, counts[1] SHA-1 entries and counts[2] SHA-256 entries
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t counts[HASH_ALGO_COUNT];
+    uint64_t wordlist_size; // a rewritten wordlist makes the offsets meaningless
+    uint32_t path_len;
+    uint32_t reserved;
+} hash_index_header_t;
+
+typedef struct {
+    uint64_t prefix; // first 8 digest bytes, big endian so numeric order is digest order
+    uint64_t offset; // start of the line in the wordlist
+} hash_index_entry_t;
+
+struct hash_index {
+    void * map;
+    size_t map_len;
+    void * words;
+    size_t words_len;
+    const hash_index_entry_t * entries[HASH_ALGO_COUNT];
+    uint64_t counts[HASH_ALGO_COUNT];
+};
+
+typedef struct {
+    const key_view_t * words;
+    size_t count;
+    const char * base;
+    hash_index_entry_t * entries[HASH_ALGO_COUNT];
+} index_build_t;
+
+static uint64_t digest_prefix(const unsigned char * digest) {
+    uint64_t prefix = 0;
+    for (int i = 0; i < 8; i++) prefix = (prefix << 8) | digest[i];
+    return prefix;
+}
+
+static size_t index_path_offset(uint32_t path_len) {
+    return (sizeof(hash_index_header_t) + path_len + 15) & ~(size_t) 15;
+}
+
+static int index_entry_compare(const void * a, const void * b) {
+    uint64_t x = ((const hash_index_entry_t *) a) -> prefix, y = ((const hash_index_entry_t *) b) -> prefix;
+    return x < y ? -1 : x > y;
+}
+
+static void index_build_task(int task, void * ctx) {
+    index_build_t * build = ctx;
+    size_t start = (size_t) task * CRACK_CHUNK;
+    size_t end = start + CRACK_CHUNK;
+    if (end > build -> count) end = build -> count;
+
+    for (int a = 0; a < HASH_ALGO_COUNT; a++) {
+        const hash_algo_t * algo = & hash_algos[a];
+        for (size_t k = start; k < end; k += HASH_LANES) {
+            int count = end - k < HASH_LANES ? (int)(end - k) : HASH_LANES;
+            const unsigned char * msgs[HASH_LANES];
+            size_t lens[HASH_LANES];
+            unsigned char digests[HASH_LANES * HASH_MAX_DIGEST];
+            for (int l = 0; l < count; l++) {
+                msgs[l] = (const unsigned char *) build -> words[k + l].data;
+                lens[l] = build -> words[k + l].len;
+            }
+            hash_lanes(algo, msgs, lens, count, digests);
+
+            for (int l = 0; l < count; l++) {
+                hash_index_entry_t * entry = & build -> entries[a][k + l];
+                entry -> prefix = digest_prefix(digests + l * algo -> digest_len);
+                entry -> offset = build -> words[k + l].data - build -> base;
+            }
+        }
+    }
+}
+
+int hash_index_build(const keychain_t * keychain, const char * wordlist_path, const char * path) {
+    if (keychain -> map_count != 1 || !wordlist_path) {
+        fprintf(stderr, "ERROR: Building an index needs exactly one wordlist (-K).\n");
+        return -1;
+    }
+
+    char full_path[PATH_MAX];
+#ifdef _WIN32
+    int resolved = _fullpath(full_path, wordlist_path, sizeof(full_path)) != NULL;
+#else
+    int resolved = realpath(wordlist_path, full_path) != NULL;
+#endif
+    if (!resolved) {
+        fprintf(stderr, "ERROR: Could not resolve wordlist path: %s\n", wordlist_path);
+        return -1;
+    }
+
+    // Only lines of the mapped file have offsets, -k keys are left out
+    const char * base = keychain -> maps[0];
+    size_t base_len = keychain -> map_lens[0];
+    key_view_t * words = malloc(sizeof(key_view_t) * (keychain -> len + 1));
+    if (!words) {
+        fprintf(stderr, "ERROR: Out of memory indexing %s\n", full_path);
+        return -1;
+    }
+    size_t count = 0;
+    for (int i = 0; i < keychain -> len; i++) {
+        const char * data = keychain -> keys[i].data;
+        if (data >= base && data < base + base_len) words[count++] = keychain -> keys[i];
+    }
+
+    index_build_t build = { .words = words, .count = count, .base = base };
+    int allocated = 1;
+    for (int a = 0; a < HASH_ALGO_COUNT; a++) {
+        build.entries[a] = malloc(sizeof(hash_index_entry_t) * (count + 1));
+        if (!build.entries[a]) allocated = 0;
+    }
+    if (!allocated) {
+        fprintf(stderr, "ERROR: Out of memory indexing %s\n", full_path);
+        for (int a = 0; a < HASH_ALGO_COUNT; a++) free(build.entries[a]);
+        free(words);
+        return -1;
+    }
+
+    printf("[INFO] Indexing %zu key(s) from %s\n", count, full_path);
+    double start = monotonic_seconds();
+    parallel_for((int)((count + CRACK_CHUNK - 1) / CRACK_CHUNK), index_build_task, & build);
+    for (int a = 0; a < HASH_ALGO_COUNT; a++) {
+        qsort(build.entries[a], count, sizeof(hash_index_entry_t), index_entry_compare);
+    }
+
+    hash_index_header_t header = {
+        .magic = HASH_INDEX_MAGIC,
+        .version = HASH_INDEX_VERSION,
+        .wordlist_size = base_len,
+        .path_len = (uint32_t) strlen(full_path)
+    };
+    for (int a = 0; a < HASH_ALGO_COUNT; a++) header.counts[a] = count;
+
+    int status = -1;
+    FILE * f = fopen(path, "wb");
+    if (f) {
+        static const char zeros[16] = { 0 };
+        size_t pad = index_path_offset(header.path_len) - sizeof(header) - header.path_len;
+        int ok = fwrite( & header, sizeof(header), 1, f) == 1 &&
+            fwrite(full_path, 1, header.path_len, f) == header.path_len &&
+            fwrite(zeros, 1, pad, f) == pad;
+        for (int a = 0; ok && a < HASH_ALGO_COUNT; a++) {
+            ok = fwrite(build.entries[a], sizeof(hash_index_entry_t), count, f) == count;
+        }
+        if (fclose(f) == 0 && ok) status = 0;
+    }
+
+    if (status == 0) {
+        printf("[INFO] Wrote %s (%zu entries per algorithm) in %.2fs\n", path, count, monotonic_seconds() - start);
+    } else {
+        fprintf(stderr, "ERROR: Could not write index file: %s\n", path);
+    }
+
+    for (int a = 0; a < HASH_ALGO_COUNT; a++) free(build.entries[a]);
+    free(words);
+    return status;
+}
+
+hash_index_t * hash_index_open(const char * path) {
+    size_t map_len = 0;
+    void * map = map_file(path, & map_len, 0);
+    const hash_index_header_t * header = map;
+    if (!map || map_len < sizeof(hash_index_header_t) ||
+        memcmp(header -> magic, HASH_INDEX_MAGIC, 4) != 0 || header -> version != HASH_INDEX_VERSION) {
+        fprintf(stderr, "ERROR: Not a ciphter index (version %d): %s\n", HASH_INDEX_VERSION, path);
+        if (map) unmap_file(map, map_len);
+        return NULL;
+    }
+
+    // Counts come from the file: each one has to fit in what is left of the mapping, so their sum can't overflow
+    size_t offset = index_path_offset(header -> path_len);
+    int truncated = header -> path_len >= PATH_MAX || offset > map_len;
+    for (size_t a = 0, end = offset; !truncated && a < HASH_ALGO_COUNT; a++) {
+        if (header -> counts[a] > (map_len - end) / sizeof(hash_index_entry_t)) truncated = 1;
+        else end += header -> counts[a] * sizeof(hash_index_entry_t);
+    }
+    if (truncated) {
+        fprintf(stderr, "ERROR: Truncated index file: %s\n", path);
+        unmap_file(map, map_len);
+        return NULL;
+    }
+
+    char wordlist[PATH_MAX];
+    memcpy(wordlist, (const char *) map + sizeof(hash_index_header_t), header -> path_len);
+    wordlist[header -> path_len] = '\0';
+
+    size_t words_len = 0;
+    void * words = map_file(wordlist, & words_len, 0);
+    if (!words || words_len != header -> wordlist_size) {
+        fprintf(stderr, "ERROR: Wordlist %s is missing or changed since the index was built\n", wordlist);
+        if (words) unmap_file(words, words_len);
+        unmap_file(map, map_len);
+        return NULL;
+    }
+
+    hash_index_t * index = calloc(1, sizeof(hash_index_t));
+    if (!index) {
+        unmap_file(words, words_len);
+        unmap_file(map, map_len);
+        return NULL;
+    }
+    index -> map = map;
+    index -> map_len = map_len;
+    index -> words = words;
+    index -> words_len = words_len;
+    for (int a = 0; a < HASH_ALGO_COUNT; a++) {
+        index -> entries[a] = (const hash_index_entry_t *)((const char *) map + offset);
+        index -> counts[a] = header -> counts[a];
+        offset += header -> counts[a] * sizeof(hash_index_entry_t);
+    }
+    return index;
+}
+
+void hash_index_close(hash_index_t * index) {
+    if (!index) return;
+    unmap_file(index -> words, index -> words_len);
+    unmap_file(index -> map, index -> map_len);
+    free(index);
+}
+
+int hash_index_lookup(const hash_index_t * index, const char * hex, size_t hex_len, const char ** algo_name, key_view_t * plain) {
+    const hash_algo_t * algo = hash_algo_for_hex(hex_len);
+    unsigned char digest[HASH_MAX_DIGEST];
+    if (!index || !algo || hex_to_digest(hex, algo -> digest_len, digest) != 0) return 0;
+
+    int a = (int)(algo - hash_algos);
+    const hash_index_entry_t * entries = index -> entries[a];
+    uint64_t prefix = digest_prefix(digest);
+
+    // Lower bound on the prefix, then confirm each candidate line by hashing it
+    size_t lo = 0, hi = index -> counts[a];
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entries[mid].prefix < prefix) lo = mid + 1;
+        else hi = mid;
+    }
+
+    const char * words = index -> words;
+    for (; lo < index -> counts[a] && entries[lo].prefix == prefix; lo++) {
+        uint64_t offset = entries[lo].offset;
+        if (offset >= index -> words_len) continue;
+
+        const char * line = words + offset;
+        const char * nl = memchr(line, '\n', index -> words_len - offset);
+        size_t len = nl ? (size_t)(nl - line) : index -> words_len - offset;
+        if (len > 0 && line[len - 1] == '\r') len--;
+
+        unsigned char check[HASH_MAX_DIGEST];
+        hash_one(algo, (const unsigned char *) line, len, check);
+        if (memcmp(check, digest, algo -> digest_len) == 0) {
+            *algo_name = algo -> name;
+            plain -> data = line;
+            plain -> len = len;
+            return 1;
+        }
+    }
+    return 0;
+}
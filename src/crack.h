@@ -0,0 +1,36 @@
+#ifndef CRACK_H
+#define CRACK_H
+
+#include "../lib/sds/sds.h"
+#include "solvers/solver_registry.h"
+
+#define CRACK_MAX_CANDIDATE 256 // longest mangled candidate, longer ones are skipped
+#define CRACK_CHUNK 4096        // wordlist entries per parallel task
+#define CRACK_DEFAULT_RULES ":"
+
+#define HASH_INDEX_MAGIC "CHIX"
+#define HASH_INDEX_VERSION 1
+
+// Dictionary attack on the MD5/SHA-1/SHA-256 hex digests in input (whitespace separated).
+// Every key is tried through every rule; rules are space separated hashcat-style op strings:
+//   :  as is          l/u  lower/upper      c/C  capitalize/inverted
+//   t  toggle case    r    reverse          d    duplicate      f  reflect
+//   [  drop first     ]    drop last        $X   append X       ^X prepend X
+//   sXY replace X with Y
+// Matches are printed as they are found. Returns the number of digests left uncracked, or -1 on bad arguments.
+int crack(sds input, const keychain_t * keychain, const char * rules);
+
+// Precomputed digest index: for every algorithm, (digest prefix -> wordlist offset) entries sorted by prefix.
+// Built once per wordlist, then memory-mapped so a lookup is a binary search with no start-up hashing.
+
+// Hashes every line of the -K wordlist at wordlist_path into an index file at path. Returns 0 on success.
+int hash_index_build(const keychain_t * keychain, const char * wordlist_path, const char * path);
+
+// Maps an index and the wordlist it was built from; NULL (with a message) if either is missing or stale
+hash_index_t * hash_index_open(const char * path);
+void hash_index_close(hash_index_t * index);
+
+// Looks up a hex digest; on a hit stores the algorithm name and a view of the wordlist line, and returns 1
+int hash_index_lookup(const hash_index_t * index, const char * hex, size_t hex_len, const char ** algo_name, key_view_t * plain);
+
+#endif // CRACK_H
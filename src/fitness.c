@@ -26,28 +26,80 @@ static const char *COMMON_BIGRAMS[] = {
 };
 #define NUM_BIGRAMS (sizeof(COMMON_BIGRAMS) / sizeof(char*))
 
-static int is_bigram_match(const char *b1, const char *b2) {
-	for (int i = 0; i < 2; i++) {
-		if (toupper((unsigned char)b1[i]) != b2[i]) return 0;
+static const float ENGLISH_FREQ[26] = {
+	0.08167, 0.01492, 0.02782, 0.04253, 0.12702, 0.02228, 0.02015, 0.06094,
+	0.06966, 0.00153, 0.00772, 0.04025, 0.02406, 0.06749, 0.07507, 0.01929, 
+	0.00095, 0.05987, 0.06327, 0.09056, 0.02758, 0.00978, 0.02360, 0.00150, 
+	0.01974, 0.00074 
+};
+
+// Bigram log-probabilities for order-sensitive fitness (transposition search). The listed bigrams
+// take most of the mass with a 1/sqrt(rank) fall-off (close to measured English
+// frequencies over the top 50), every other pair shares the rest in proportion
+// to its letters' frequencies.
+#define BIGRAM_LISTED_MASS 0.7f
+
+static float bigram_log_table[26][26];
+static int bigram_log_built = 0;
+
+static void build_bigram_log_table(void) {
+	float listed[26][26] = {{0}};
+	float zipf_total = 0.0f;
+	for (size_t r = 0; r < NUM_BIGRAMS; r++) zipf_total += 1.0f / sqrtf(r + 1);
+	for (size_t r = 0; r < NUM_BIGRAMS; r++) {
+		listed[COMMON_BIGRAMS[r][0] - 'A'][COMMON_BIGRAMS[r][1] - 'A'] = BIGRAM_LISTED_MASS / sqrtf(r + 1) / zipf_total;
+	}
+
+	float rest_total = 0.0f;
+	for (int a = 0; a < 26; a++) {
+		for (int b = 0; b < 26; b++) {
+			if (listed[a][b] == 0.0f) rest_total += ENGLISH_FREQ[a] * ENGLISH_FREQ[b];
+		}
+	}
+
+	for (int a = 0; a < 26; a++) {
+		for (int b = 0; b < 26; b++) {
+			float p = listed[a][b];
+			if (p == 0.0f) p = (1.0f - BIGRAM_LISTED_MASS) * ENGLISH_FREQ[a] * ENGLISH_FREQ[b] / rest_total;
+			bigram_log_table[a][b] = logf(p);
+		}
 	}
-	return 1;
+	bigram_log_built = 1;
 }
 
-float score_english_bigram(const char *text, size_t len) {
-	if (len < 2) return 0.0f;
+const float (*bigram_log_probs(void))[26] {
+	if (!bigram_log_built) build_bigram_log_table();
+	return (const float (*)[26])bigram_log_table;
+}
 
-	int match_count = 0;
-	int total_bigrams = len - 1;
+// Listed-bigram membership, indexed by case-folded letter (1-26, 0 for anything else), so the scan is
+// two table loads and an add per position instead of a compare against every listed bigram.
+// byte_class flags what the casing score looks at, so no scan needs ctype calls.
+#define BYTE_UPPER 1
+#define BYTE_TERMINATOR 2 // ends a sentence: . ! ?
 
-	for (int i = 0; i < total_bigrams; i++) {
-		// Check if the current bigram in text matches any of the common ones
-		for (int j = 0; j < NUM_BIGRAMS; j++) {
-			if (is_bigram_match(&text[i], COMMON_BIGRAMS[j])) {
-				match_count++;
-				break; // Found a match
-			}
-		}
+static unsigned char letter_fold[256];
+static unsigned char byte_class[256];
+static unsigned char bigram_listed[27][27];
+static int english_tables_built = 0;
+
+static void build_english_tables(void) {
+	for (int c = 'A'; c <= 'Z'; c++) {
+		letter_fold[c] = c - 'A' + 1;
+		letter_fold[tolower(c)] = c - 'A' + 1;
+		byte_class[c] = BYTE_UPPER;
+	}
+	byte_class['.'] = byte_class['!'] = byte_class['?'] = BYTE_TERMINATOR;
+	for (size_t r = 0; r < NUM_BIGRAMS; r++) {
+		bigram_listed[letter_fold[(unsigned char)COMMON_BIGRAMS[r][0]]][letter_fold[(unsigned char)COMMON_BIGRAMS[r][1]]] = 1;
 	}
+	english_tables_built = 1;
+}
+
+// Bigram score from the listed-bigram hits among the len - 1 pairs
+static float bigram_hits_score(int match_count, size_t len) {
+	if (len < 2) return 0.0f;
+	int total_bigrams = len - 1;
 
 	float density = (float)match_count / total_bigrams;
 	
@@ -73,6 +125,127 @@ float score_english_bigram(const char *text, size_t len) {
 	return score;
 }
 
+float score_english_bigram(const char *text, size_t len) {
+	if (len < 2) return 0.0f;
+	if (!english_tables_built) build_english_tables();
+
+	const unsigned char *p = (const unsigned char *)text;
+	int match_count = 0;
+
+	unsigned char prev = letter_fold[p[0]];
+	for (size_t i = 1; i < len; i++) {
+		unsigned char cur = letter_fold[p[i]];
+		match_count += bigram_listed[prev][cur];
+		prev = cur;
+	}
+	return bigram_hits_score(match_count, len);
+}
+
+static const float *quadgram_logp = NULL;
+static float quadgram_english_mean = 0.0f;
+static float quadgram_random_mean = 0.0f;
+static float quadgram_best_logp = 0.0f; // most likely quadgram, what the rest of a text can add at most
+
+void set_quadgram_table(const float *logp, float english_mean, float random_mean) {
+	quadgram_logp = logp;
+	quadgram_english_mean = english_mean;
+	quadgram_random_mean = random_mean;
+
+	quadgram_best_logp = -INFINITY;
+	for (int q = 0; logp && q < 26 * 26 * 26 * 26; q++) {
+		if (logp[q] > quadgram_best_logp) quadgram_best_logp = logp[q];
+	}
+}
+
+const float *quadgram_log_probs(void) {
+	return quadgram_logp;
+}
+
+// Quadgram score from the letter histogram and the log-probabilities summed over count quadgrams
+static float quadgram_sum_score(const int letters[26], double total, int count) {
+	if (count == 0) return 0.0f;
+
+	// A few letters repeated ("sseesess") can string common quadgrams together; letters that are not
+	// English in any order score nothing. 25 is the chi-squared expected from sampling alone.
+	int letter_total = count + 3;
+	if (chi_squared_english(letters, letter_total) > QUADGRAM_MAX_CHI * letter_total + 25.0f) return 0.0f;
+
+	float score = ((float)(total / count) - quadgram_random_mean) / (quadgram_english_mean - quadgram_random_mean);
+	if (score < 0.0f) score = 0.0f;
+	if (score > 1.0f) score = 1.0f;
+	return score;
+}
+
+float score_quadgrams(const char *text, size_t len) {
+	if (!quadgram_logp || quadgram_english_mean <= quadgram_random_mean) return 0.0f;
+	if (!english_tables_built) build_english_tables();
+
+	// Rolling base-26 index over the letters, the oldest one drops out as the next comes in
+	const unsigned char *p = (const unsigned char *)text;
+	int letters[26] = {0};
+	unsigned int index = 0;
+	int run = 0;
+	int count = 0;
+	double total = 0.0;
+	for (size_t i = 0; i < len; i++) {
+		unsigned char f = letter_fold[p[i]];
+		if (!f) continue;
+		letters[f - 1]++;
+		index = (index % (26 * 26 * 26)) * 26 + (f - 1);
+		if (run < 3) {
+			run++;
+			continue;
+		}
+		total += quadgram_logp[index];
+		count++;
+	}
+	return quadgram_sum_score(letters, total, count);
+}
+
+#define QUADGRAM_BOUND_STRIDE 64 // bytes scanned between checks of the bound
+
+float score_quadgrams_bounded(const char *text, size_t len, float need) {
+	if (!quadgram_logp || quadgram_english_mean <= quadgram_random_mean) return need > 0.0f ? -1.0f : 0.0f;
+	if (need <= 0.0f) return score_quadgrams(text, len);
+	if (need > 1.0f) return -1.0f;
+	if (!english_tables_built) build_english_tables();
+
+	// Mean log-probability per quadgram that maps to need
+	double need_mean = quadgram_random_mean + (double)need * (quadgram_english_mean - quadgram_random_mean);
+
+	const unsigned char *p = (const unsigned char *)text;
+	int letters[26] = {0};
+	unsigned int index = 0;
+	int run = 0;
+	int count = 0;
+	double total = 0.0;
+	size_t check = QUADGRAM_BOUND_STRIDE;
+	for (size_t i = 0; i < len; i++) {
+		if (i == check) {
+			// Best case: every remaining byte completes a quadgram as likely as the best one. The mean moves
+			// monotonically towards that, so the bound is the better of stopping here and taking all of them.
+			check += QUADGRAM_BOUND_STRIDE;
+			double rest = (double)(len - i);
+			double best = (total + rest * quadgram_best_logp) / (count + rest);
+			if (count > 0 && total / count > best) best = total / count;
+			if (best < need_mean) return -1.0f;
+		}
+		unsigned char f = letter_fold[p[i]];
+		if (!f) continue;
+		letters[f - 1]++;
+		index = (index % (26 * 26 * 26)) * 26 + (f - 1);
+		if (run < 3) {
+			run++;
+			continue;
+		}
+		total += quadgram_logp[index];
+		count++;
+	}
+	return quadgram_sum_score(letters, total, count);
+}
+
+static float casing_counts_score(int total_chars, int upper_count, int sentence_start_checks, int sentence_start_hits, size_t len);
+
 float score_english_casing(const char *text, size_t len) {
 	if (len == 0) return 0.0f;
 
@@ -106,6 +279,11 @@ float score_english_casing(const char *text, size_t len) {
 		}
 	}
 
+	return casing_counts_score(total_chars, upper_count, sentence_start_checks, sentence_start_hits, len);
+}
+
+// Casing score from letter and capital counts and sentence starts (letters first after a terminator)
+static float casing_counts_score(int total_chars, int upper_count, int sentence_start_checks, int sentence_start_hits, size_t len) {
 	if (total_chars == 0) return 0.0f;
 
 	float casing_ratio = (float)upper_count / total_chars;
@@ -151,53 +329,193 @@ float score_english_casing(const char *text, size_t len) {
 #define SENTENCE_WEIGHT 0.4f
 #define CASING_WEIGHT 0.6f
 
-static const float ENGLISH_FREQ[26] = {
-	0.08167, 0.01492, 0.02782, 0.04253, 0.12702, 0.02228, 0.02015, 0.06094,
-	0.06966, 0.00153, 0.00772, 0.04025, 0.02406, 0.06749, 0.07507, 0.01929, 
-	0.00095, 0.05987, 0.06327, 0.09056, 0.02758, 0.00978, 0.02360, 0.00150, 
-	0.01974, 0.00074 
-};
-
-static float score_letter_frequency(const char *text, size_t len) {
-	int counts[26] = {0};
-	int total = 0;
-	for(size_t i=0; i<len; i++) {
-		if(isalpha((unsigned char)text[i])) {
-			counts[tolower((unsigned char)text[i]) - 'a']++;
-			total++;
-		}
-	}
-	if(total == 0) return 0.0f;
-	
+float chi_squared_english(const int counts[26], int total) {
 	float chi_sq = 0.0f;
 	for(int i=0; i<26; i++) {
 		float expected = ENGLISH_FREQ[i] * total;
 		float diff = counts[i] - expected;
 		chi_sq += (diff * diff) / (expected + 0.0001f);
 	}
+	return chi_sq;
+}
+
+int best_caesar_shift(const int counts[26], int total, float *chi_out) {
+	int best = 0;
+	float best_chi = -1.0f;
+	for (int s = 0; s < 26; s++) {
+		int shifted[26];
+		for (int i = 0; i < 26; i++) shifted[i] = counts[(i + s) % 26];
+
+		float chi = chi_squared_english(shifted, total);
+		if (best_chi < 0.0f || chi < best_chi) {
+			best_chi = chi;
+			best = s;
+		}
+	}
+	if (chi_out) *chi_out = best_chi;
+	return best;
+}
+
+float index_of_coincidence(const int counts[26], int total) {
+	if (total < 2) return 0.0f;
+
+	long pairs = 0;
+	for (int i = 0; i < 26; i++) pairs += (long)counts[i] * (counts[i] - 1);
+	return (float)pairs / ((float)total * (total - 1));
+}
+
+static float letter_counts_score(const int counts[26], int total) {
+	if(total == 0) return 0.0f;
+	
+	float chi_sq = chi_squared_english(counts, total);
 	
 	// Stricter frequency curve
 	return 50.0f / (50.0f + chi_sq);
 }
 
+float score_letter_frequency(const char *text, size_t len) {
+	if (!english_tables_built) build_english_tables();
+
+	// Slot 0 collects everything that is not a letter
+	int folded[27] = {0};
+	for(size_t i=0; i<len; i++) folded[letter_fold[(unsigned char)text[i]]]++;
+	return letter_counts_score(folded + 1, (int)len - folded[0]);
+}
+
+void byte_histogram(const char *text, size_t len, int counts[256]) {
+	// Four interleaved tables so runs of the same byte don't serialise on one counter
+	int lanes[4][256] = {{0}};
+	const unsigned char *p = (const unsigned char *)text;
+	size_t i = 0;
+	for (; i + 4 <= len; i += 4) {
+		lanes[0][p[i]]++;
+		lanes[1][p[i + 1]]++;
+		lanes[2][p[i + 2]]++;
+		lanes[3][p[i + 3]]++;
+	}
+	for (; i < len; i++) lanes[0][p[i]]++;
+
+	for (int c = 0; c < 256; c++) {
+		counts[c] = lanes[0][c] + lanes[1][c] + lanes[2][c] + lanes[3][c];
+	}
+}
+
+float score_byte_histogram(const int counts[256], int total) {
+	if (total == 0) return 0.0f;
+
+	int letters[26] = {0};
+	int letter_total = 0;
+	int lower = 0;
+	int printable = 0;
+	for (int c = 0; c < 256; c++) {
+		if (counts[c] == 0) continue;
+		if (isprint(c) || c == '\n' || c == '\r' || c == '\t') printable += counts[c];
+		if (isalpha(c)) {
+			letters[tolower(c) - 'a'] += counts[c];
+			letter_total += counts[c];
+			if (islower(c)) lower += counts[c];
+		}
+	}
+	if (letter_total == 0) return 0.0f;
+
+	float s_freq = 50.0f / (50.0f + chi_squared_english(letters, letter_total));
+	float s_letters = (float)(letter_total + counts[' ']) / total;
+	float s_printable = (float)printable / total;
+	// Mostly lowercase, breaks the tie between a byte and its case-flipped twin (x ^ 0x20)
+	float s_case = 0.9f + 0.1f * lower / letter_total;
+
+	return s_freq * s_letters * s_printable * s_case;
+}
+
 // Uses weights defined in utils.h
-float score_english_detailed(const char *text, size_t len) {
-	float s_bigram = score_english_bigram(text, len);
+float score_english_detailed_passes(const char *text, size_t len) {
+	float s_bigram = quadgram_logp ? score_quadgrams(text, len) : score_english_bigram(text, len);
 	float s_casing = score_english_casing(text, len);
 	float s_freq = score_letter_frequency(text, len);
 
 	return (s_freq * WEIGHT_FREQ) + (s_bigram * WEIGHT_BIGRAM) + (s_casing * WEIGHT_CASING);
 }
 
-// Shannon Entropy Calculation
-float score_shannon_entropy(const char *text, size_t len) {
-    if (len == 0) return 0.0f;
+// Everything the English score needs, gathered in one pass
+typedef struct {
+	int folded[27]; // letter histogram, [0] counts everything else
+	int bigram_hits;
+	int upper;
+	int sentence_checks; // letters first after the start or a terminator
+	int sentence_hits;   // ... that are capitals
+	int quad_count;
+	double quad_total;
+} english_stats_t;
 
-    int counts[256] = {0};
-    for (size_t i = 0; i < len; ++i) {
-        counts[(unsigned char)text[i]]++;
-    }
+// Every byte goes through the fold and class tables once and each counter is a plain add of a table
+// value, so the loop has no data-dependent branches. Called with quad constant (NULL or the model) so
+// each call site compiles to its own loop.
+static inline void english_scan(const unsigned char *p, size_t len, const float *quad, english_stats_t *stats) {
+	// Counters stay in locals: the histogram stores could alias them through stats
+	int bigram_hits = 0, upper = 0, sentence_checks = 0, sentence_hits = 0;
+	int expect_capital = 1;
+	unsigned char prev = 0; // no bigram starts before the text
+	unsigned int quad_index = 0;
+	int quad_run = 0, quad_count = 0;
+	double quad_total = 0.0;
+
+	for (size_t i = 0; i < len; i++) {
+		unsigned char f = letter_fold[p[i]];
+		unsigned char cls = byte_class[p[i]];
+		int letter = f != 0;
+		int capital = cls & BYTE_UPPER;
 
+		stats->folded[f]++;
+		bigram_hits += bigram_listed[prev][f];
+		prev = f;
+
+		upper += capital;
+		sentence_checks += letter & expect_capital;
+		sentence_hits += capital & expect_capital;
+		expect_capital = (expect_capital & !letter) | (cls >> 1);
+
+		if (quad) {
+			// Selects instead of branches: letters and the rest are interleaved unpredictably
+			unsigned int next = (quad_index % (26 * 26 * 26)) * 26 + (f - 1);
+			int full = letter & (quad_run >= 3);
+			quad_index = letter ? next : quad_index;
+			quad_total += full ? quad[quad_index] : 0.0f;
+			quad_count += full;
+			quad_run += letter & (quad_run < 3);
+		}
+	}
+
+	stats->bigram_hits = bigram_hits;
+	stats->upper = upper;
+	stats->sentence_checks = sentence_checks;
+	stats->sentence_hits = sentence_hits;
+	stats->quad_count = quad_count;
+	stats->quad_total = quad_total;
+}
+
+// Same score as score_english_detailed_passes from a single scan
+float score_english_detailed(const char *text, size_t len) {
+	if (!english_tables_built) build_english_tables();
+
+	const unsigned char *p = (const unsigned char *)text;
+	const float *quad = quadgram_english_mean > quadgram_random_mean ? quadgram_logp : NULL;
+	english_stats_t stats = {{0}};
+	if (quad) english_scan(p, len, quad, &stats);
+	else english_scan(p, len, NULL, &stats);
+
+	int letters = (int)len - stats.folded[0];
+	float s_bigram;
+	if (quadgram_logp) s_bigram = quad ? quadgram_sum_score(stats.folded + 1, stats.quad_total, stats.quad_count) : 0.0f;
+	else s_bigram = bigram_hits_score(stats.bigram_hits, len);
+	float s_casing = len == 0 ? 0.0f : casing_counts_score(letters, stats.upper, stats.sentence_checks, stats.sentence_hits, len);
+	float s_freq = letter_counts_score(stats.folded + 1, letters);
+
+	return (s_freq * WEIGHT_FREQ) + (s_bigram * WEIGHT_BIGRAM) + (s_casing * WEIGHT_CASING);
+}
+
+// Shannon Entropy Calculation
+// Shannon entropy (bits per byte) of a byte histogram over len bytes
+static float histogram_entropy(const int counts[256], size_t len) {
     float entropy = 0.0f;
     for (int i = 0; i < 256; ++i) {
         if (counts[i] > 0) {
@@ -205,10 +523,33 @@ float score_shannon_entropy(const char *text, size_t len) {
             entropy -= p * log2f(p);
         }
     }
+    return entropy;
+}
+
+float score_shannon_entropy(const char *text, size_t len) {
+    if (len == 0) return 0.0f;
+
+    int counts[256];
+    byte_histogram(text, len, counts);
 
     // Normalize entropy (0-8) to 0.0-1.0 range (higher is better structure)
     // 8.0 is max entropy (random bytes), 0.0 is min entropy (single repeated char)
-    return entropy;
+    return histogram_entropy(counts, len);
+}
+
+static int is_text_byte(int c) {
+	return isprint(c) || c == '\n' || c == '\r' || c == '\t';
+}
+
+static float combined_score(int non_printable, float entropy, int force_shannon) {
+	// Formula: (1/2)^N
+	if (!force_shannon && non_printable == 0) {
+		return 1.0f;
+	}
+
+	float ent_score = (8.0f - entropy) / 8.0f;
+	if (ent_score < 0) ent_score = 0;
+	return ent_score;
 }
 
 float score_combined(const char *text, size_t len, int force_shannon) {
@@ -216,21 +557,298 @@ float score_combined(const char *text, size_t len, int force_shannon) {
 	
 	int non_printable = 0;
 	for (size_t i = 0; i < len; i++) {
-		unsigned char c = (unsigned char)text[i];
 		// Check for printable (including standard whitespace)
-		if (!isprint(c) && c != '\n' && c != '\r' && c != '\t') {
+		if (!is_text_byte((unsigned char)text[i])) {
 			non_printable = 1;
 			break;
 		}
 	}
 
-	// Formula: (1/2)^N
-	if (!force_shannon && non_printable == 0) {
-		return 1.0f;
+	// Printable text needs no entropy
+	if (!force_shannon && non_printable == 0) return 1.0f;
+	return combined_score(non_printable, score_shannon_entropy(text, len), force_shannon);
+}
+
+void text_stats_gather(const char *text, size_t len, text_stats_t *stats) {
+	byte_histogram(text, len, stats->counts);
+	stats->len = len;
+	stats->non_printable = 0;
+	for (int c = 0; c < 256; c++) {
+		if (!is_text_byte(c)) stats->non_printable += stats->counts[c];
+	}
+	stats->entropy = len ? histogram_entropy(stats->counts, len) : 0.0f;
+}
+
+void text_stats_derive(const text_stats_t *parent, const text_transform_t *transform, text_stats_t *child) {
+	if (transform->kind == TRANSFORM_TRANSPOSE) {
+		// Same bytes in another order
+		if (child != parent) *child = *parent;
+		return;
 	}
 
-	float ent = score_shannon_entropy(text, len);
-	float ent_score = (8.0f - ent) / 8.0f;
-	if (ent_score < 0) ent_score = 0;
-	return ent_score;
-}
\ No newline at end of file
+	int counts[256] = {0};
+	int hit[256] = {0};
+	int injective = 1;
+	for (int c = 0; c < 256; c++) {
+		unsigned char to = transform->map[c];
+		counts[to] += parent->counts[c];
+		// Only bytes that occur matter: merging two of them changes the entropy
+		if (parent->counts[c] > 0) {
+			if (hit[to]) injective = 0;
+			hit[to] = 1;
+		}
+	}
+
+	memcpy(child->counts, counts, sizeof(counts));
+	child->len = parent->len;
+	child->non_printable = 0;
+	for (int c = 0; c < 256; c++) {
+		if (!is_text_byte(c)) child->non_printable += counts[c];
+	}
+	// Entropy only sees the multiset of counts, which a one-to-one map just relabels
+	if (!injective) child->entropy = child->len ? histogram_entropy(counts, child->len) : 0.0f;
+	else child->entropy = parent->entropy;
+}
+
+float score_combined_stats(const text_stats_t *stats, int force_shannon) {
+	if (stats->len == 0) return 0.0f;
+	return combined_score(stats->non_printable, stats->entropy, force_shannon);
+}
+// ==========================================
+// Periodicity
+// ==========================================
+
+// Writes signal k of length n into out, for autocorrelations summed over several signals
+typedef void (*signal_fill_fn)(const void *ctx, int k, size_t n, double *out);
+
+// In-place iterative radix-2 FFT, n a power of two
+static void fft(double *re, double *im, size_t n, int inverse) {
+	for (size_t i = 1, j = 0; i < n; i++) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			double t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+
+	for (size_t len = 2; len <= n; len <<= 1) {
+		double angle = (inverse ? 2.0 : -2.0) * M_PI / len;
+		double wr = cos(angle), wi = sin(angle);
+		for (size_t i = 0; i < n; i += len) {
+			double cr = 1.0, ci = 0.0;
+			for (size_t j = 0; j < len / 2; j++) {
+				size_t a = i + j, b = a + len / 2;
+				double tr = re[b] * cr - im[b] * ci;
+				double ti = re[b] * ci + im[b] * cr;
+				re[b] = re[a] - tr; im[b] = im[a] - ti;
+				re[a] += tr; im[a] += ti;
+				double next = cr * wr - ci * wi;
+				ci = cr * wi + ci * wr;
+				cr = next;
+			}
+		}
+	}
+}
+
+static size_t fft_size(size_t n, int max_shift) {
+	size_t size = 1;
+	while (size < n + (size_t)max_shift) size <<= 1;
+	return size;
+}
+
+// Estimated cost of autocorrelating count real signals by FFT, in the same units as n * shifts direct comparisons
+static double fft_cost(size_t n, int max_shift, int count) {
+	double size = (double)fft_size(n, max_shift);
+	return AUTOCORR_FFT_COST * ((count + 1) / 2) * 2.0 * size * log2(size);
+}
+
+// sums[p] = sum over signals of sum_i s[i] * s[i + p], p in [1, max_shift]. Two real signals share one complex
+// transform (x + iy): the real part of its autocorrelation is exactly the sum of theirs.
+static void autocorrelate_fft(signal_fill_fn fill, const void *ctx, int count, size_t n, int max_shift, double *sums) {
+	size_t size = fft_size(n, max_shift);
+	double *re = malloc(sizeof(double) * size);
+	double *im = malloc(sizeof(double) * size);
+	if (!re || !im) {
+		free(re);
+		free(im);
+		return;
+	}
+
+	for (int k = 0; k < count; k += 2) {
+		memset(re + n, 0, sizeof(double) * (size - n));
+		memset(im, 0, sizeof(double) * size);
+		fill(ctx, k, n, re);
+		if (k + 1 < count) fill(ctx, k + 1, n, im);
+
+		fft(re, im, size, 0);
+		for (size_t i = 0; i < size; i++) {
+			re[i] = re[i] * re[i] + im[i] * im[i];
+			im[i] = 0.0;
+		}
+		fft(re, im, size, 1);
+
+		for (int p = 1; p <= max_shift; p++) sums[p] += re[p] / size;
+	}
+
+	free(re);
+	free(im);
+}
+
+typedef struct {
+	const unsigned char *symbols;
+	const int *present; // symbol of each signal
+} indicator_ctx_t;
+
+static void fill_indicator(const void *ctx, int k, size_t n, double *out) {
+	const indicator_ctx_t *c = ctx;
+	int symbol = c->present[k];
+	for (size_t i = 0; i < n; i++) out[i] = c->symbols[i] == symbol;
+}
+
+static void fill_bit_plane(const void *ctx, int k, size_t n, double *out) {
+	const unsigned char *data = ctx;
+	for (size_t i = 0; i < n; i++) out[i] = ((data[i] >> k) & 1) ? 1.0 : -1.0;
+}
+
+void letter_coincidences(const unsigned char *letters, size_t n, int max_shift, double *matches) {
+	memset(matches, 0, sizeof(double) * (max_shift + 1));
+	if (max_shift < 1 || (size_t)max_shift >= n) return;
+
+	int present[26];
+	int count = 0;
+	int seen[26] = {0};
+	for (size_t i = 0; i < n; i++) seen[letters[i]] = 1;
+	for (int c = 0; c < 26; c++) {
+		if (seen[c]) present[count++] = c;
+	}
+
+	if (fft_cost(n, max_shift, count) < (double)n * max_shift) {
+		indicator_ctx_t ctx = { letters, present };
+		autocorrelate_fft(fill_indicator, &ctx, count, n, max_shift, matches);
+		for (int p = 1; p <= max_shift; p++) matches[p] = round(matches[p]);
+		return;
+	}
+
+	for (int p = 1; p <= max_shift; p++) {
+		size_t hits = 0;
+		for (size_t i = 0; i + p < n; i++) hits += letters[i] == letters[i + p];
+		matches[p] = (double)hits;
+	}
+}
+
+void bit_distances(const unsigned char *data, size_t n, int max_shift, double *distances) {
+	memset(distances, 0, sizeof(double) * (max_shift + 1));
+	if (max_shift < 1 || (size_t)max_shift >= n) return;
+
+	if (fft_cost(n, max_shift, 8) < (double)n * max_shift) {
+		// With bits as +-1, each plane correlates to agreements - disagreements over the n - p pairs
+		autocorrelate_fft(fill_bit_plane, data, 8, n, max_shift, distances);
+		for (int p = 1; p <= max_shift; p++) {
+			distances[p] = round((8.0 * (n - p) - distances[p]) / 2.0);
+		}
+		return;
+	}
+
+	for (int p = 1; p <= max_shift; p++) {
+		size_t bits = 0;
+		for (size_t i = 0; i + p < n; i++) bits += __builtin_popcount(data[i] ^ data[i + p]);
+		distances[p] = (double)bits;
+	}
+}
+
+// Scores each candidate period by how far the mean rate at its multiples stands above the mean rate at
+// every other shift. A divisor of the key period mixes periodic and random shifts in its multiples, and a
+// multiple leaves some periodic shifts among the others, so the true period separates best. Returns the
+// smallest period scoring near the best, 0 unless it clears PERIOD_MIN_LIFT. rates are from index 2 and
+// "higher is more periodic".
+static int pick_period(const float *rates, int max_period, float *lift) {
+	*lift = 1.0f;
+	if (max_period < PERIOD_MIN_SHIFTS + 1) return 0;
+
+	double total = 0.0;
+	for (int p = 2; p <= max_period; p++) total += rates[p];
+	int shifts = max_period - 1;
+
+	float *scores = malloc(sizeof(float) * (max_period + 1));
+	if (!scores) return 0;
+
+	float best = 0.0f;
+	for (int p = 2; p <= max_period; p++) {
+		double in = 0.0;
+		int count = 0;
+		for (int m = p; m <= max_period; m += p) {
+			in += rates[m];
+			count++;
+		}
+		scores[p] = 0.0f;
+		if (count < PERIOD_MIN_MULTIPLES || count == shifts) continue;
+		double out = (total - in) / (shifts - count);
+		if (out > 0.0) scores[p] = (float)((in / count) / out);
+		if (scores[p] > best) best = scores[p];
+	}
+
+	int period = 0;
+	for (int p = 2; p <= max_period && !period; p++) {
+		if (scores[p] < PERIOD_PEAK_SHARE * best) continue;
+		*lift = scores[p];
+		period = *lift >= PERIOD_MIN_LIFT ? p : -1;
+	}
+	free(scores);
+	return period > 0 ? period : 0;
+}
+
+int coincidence_period(const unsigned char *letters, size_t n, int max_period, float *lift) {
+	*lift = 1.0f;
+	if (max_period < 2 || (size_t)max_period >= n) return 0;
+
+	double *matches = malloc(sizeof(double) * (max_period + 1));
+	float *rates = malloc(sizeof(float) * (max_period + 1));
+	int period = 0;
+	if (matches && rates) {
+		letter_coincidences(letters, n, max_period, matches);
+		for (int p = 1; p <= max_period; p++) rates[p] = (float)(matches[p] / (n - p));
+		period = pick_period(rates, max_period, lift);
+	}
+	free(matches);
+	free(rates);
+	return period;
+}
+
+int hamming_period(const unsigned char *data, size_t n, int max_period, float *lift) {
+	*lift = 1.0f;
+	if (max_period < 2 || (size_t)max_period >= n) return 0;
+
+	double *distances = malloc(sizeof(double) * (max_period + 1));
+	float *rates = malloc(sizeof(float) * (max_period + 1));
+	int period = 0;
+	if (distances && rates) {
+		bit_distances(data, n, max_period, distances);
+		// Agreeing bits per byte pair, so that like coincidences higher means more periodic
+		for (int p = 1; p <= max_period; p++) rates[p] = (float)(8.0 - distances[p] / (n - p));
+		period = pick_period(rates, max_period, lift);
+	}
+	free(distances);
+	free(rates);
+	return period;
+}
+
+void kasiski_votes(const unsigned char *letters, int n, int max_period, int votes[]) {
+	int *last_seen = malloc(sizeof(int) * 26 * 26 * 26);
+	if (!last_seen) return;
+	memset(last_seen, -1, sizeof(int) * 26 * 26 * 26);
+
+	for (int i = 0; i + 2 < n; i++) {
+		int tri = (letters[i] * 26 + letters[i + 1]) * 26 + letters[i + 2];
+		if (last_seen[tri] >= 0) {
+			int spacing = i - last_seen[tri];
+			for (int p = 2; p <= max_period; p++) {
+				if (spacing % p == 0) votes[p]++;
+			}
+		}
+		last_seen[tri] = i;
+	}
+
+	free(last_seen);
+}
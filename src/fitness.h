@@ -15,13 +15,110 @@ extern float score_shannon_entropy(const char *text, size_t len);
 // Score text based on English bigram frequency. Higher is better.
 extern float score_english_bigram(const char *text, size_t len);
 
+// 26x26 table of English bigram log-probabilities, indexed [first letter][second letter] (0 = 'a').
+// For order-sensitive searches that score candidates without building them.
+extern const float (*bigram_log_probs(void))[26];
+
+// Quadgram fitness, from a model file loaded at start-up (quadgram.h). logp holds 26^4 natural-log probabilities
+// indexed by four letters in base 26 (a = 0); english_mean and random_mean are the mean log-probability per
+// quadgram of the model's corpus and of uniformly random letters. NULL logp unloads it.
+extern void set_quadgram_table(const float *logp, float english_mean, float random_mean);
+
+#define QUADGRAM_MAX_CHI 1.0f // letter chi-squared per letter (past sampling noise) beyond which quadgrams are not scored
+
+// The loaded quadgram table, or NULL
+extern const float *quadgram_log_probs(void);
+
+// Mean quadgram log-probability of the letters in text (other bytes skipped) mapped onto 0 (random letters)
+// to 1 (English), clamped. 0 without a model or with fewer than four letters.
+extern float score_quadgrams(const char *text, size_t len);
+
+// score_quadgrams for branch-and-bound: stops and returns -1 as soon as the rest of the text can no longer
+// lift the score to need. Otherwise the same score.
+extern float score_quadgrams_bounded(const char *text, size_t len, float need);
+
 // Score text based on correct casing (capitalization). Higher is better.
 extern float score_english_casing(const char *text, size_t len);
 
-// Detailed English score (bigrams, casing, freq, etc.) for filtering output
+// Score text based on its letter frequencies (chi-squared against English). Higher is better.
+extern float score_letter_frequency(const char *text, size_t len);
+
+// Detailed English score (bigrams, casing, freq, etc.) for filtering output. With a quadgram model
+// loaded its score stands in for the bigram term. Gathers every term in a single pass over the text.
 extern float score_english_detailed(const char *text, size_t len);
 
+// The same score from the separate bigram, casing and frequency scans. Reference for the benchmark.
+extern float score_english_detailed_passes(const char *text, size_t len);
+
+// Chi-squared distance of a letter histogram (a-z) from English letter frequencies. Lower is better.
+extern float chi_squared_english(const int counts[26], int total);
+
+// Shift (0-25) that best turns a Caesar-shifted letter histogram back into English. Optionally returns its chi-squared.
+extern int best_caesar_shift(const int counts[26], int total, float *chi_out);
+
+// Index of coincidence of a letter histogram. English is ~0.067, uniformly random letters ~0.038.
+extern float index_of_coincidence(const int counts[26], int total);
+
+// Counts of every byte value in the text.
+extern void byte_histogram(const char *text, size_t len, int counts[256]);
+
+// English likeness (0-1) of a raw byte histogram: letter frequency, letter/space density and printability.
+// Lets solvers rank keys that permute bytes without building each candidate. Higher is better.
+extern float score_byte_histogram(const int counts[256], int total);
+
+// Periodicity. Autocorrelations are exact; past a cost crossover they are computed with FFTs (O(n log n))
+// instead of comparing every shift directly (O(n * shifts)).
+#define AUTOCORR_FFT_COST 4.0   // FFT butterfly cost relative to one direct comparison
+#define PERIOD_MIN_SHIFTS 4     // shifts needed to tell periodic from other shifts
+#define PERIOD_MIN_MULTIPLES 3  // fewer multiples in range are too noisy to rank
+#define PERIOD_PEAK_SHARE 0.9f  // a multiple of the period scores about as well as the period itself
+#define PERIOD_MIN_LIFT 1.2f    // how far the period's shifts must stand above the others
+
+// matches[p] = positions i with letters[i] == letters[i + p], p in [1, max_shift]. letters are 0-25.
+extern void letter_coincidences(const unsigned char *letters, size_t n, int max_shift, double *matches);
+
+// distances[p] = differing bits between data[i] and data[i + p] summed over i, p in [1, max_shift].
+extern void bit_distances(const unsigned char *data, size_t n, int max_shift, double *distances);
+
+// Likely polyalphabetic (Vigenere) key period from letter coincidences, 0 if none. lift = rate at its multiples / rate elsewhere.
+extern int coincidence_period(const unsigned char *letters, size_t n, int max_period, float *lift);
+
+// Likely repeating-key XOR period from bit agreement between shifted bytes, 0 if none.
+extern int hamming_period(const unsigned char *data, size_t n, int max_period, float *lift);
+
+// Kasiski examination: every repeated trigram votes for each period (2..max_period) dividing its spacing.
+extern void kasiski_votes(const unsigned char *letters, int n, int max_period, int votes[]);
+
 // Combined fitness score for solver pathfinding (Printability only)
 extern float score_combined(const char *text, size_t len, int force_shannon);
 
+// Order-independent statistics of a text. A solver gathers them once for its input and derives each
+// candidate's from them, since its transform only moves or relabels bytes; only order-dependent terms
+// (bigrams, quadgrams) still need the candidate text.
+typedef struct {
+	int counts[256];   // byte histogram
+	size_t len;
+	int non_printable; // bytes other than printable text and \n \r \t
+	float entropy;     // Shannon entropy, bits per byte
+} text_stats_t;
+
+typedef enum {
+	TRANSFORM_TRANSPOSE, // positions permuted, bytes kept (rail fence, columnar, reverse)
+	TRANSFORM_BYTE_MAP   // every byte b becomes map[b] (Caesar, affine, ROT47)
+} text_transform_kind_t;
+
+typedef struct {
+	text_transform_kind_t kind;
+	const unsigned char *map; // TRANSFORM_BYTE_MAP only, 256 entries
+} text_transform_t;
+
+extern void text_stats_gather(const char *text, size_t len, text_stats_t *stats);
+
+// Statistics of the text the transform makes from the parent's, without the text. child may be parent.
+// A one-to-one byte map keeps the parent's entropy, which a rescan matches up to float summation order.
+extern void text_stats_derive(const text_stats_t *parent, const text_transform_t *transform, text_stats_t *child);
+
+// score_combined of the text the statistics came from
+extern float score_combined_stats(const text_stats_t *stats, int force_shannon);
+
 #endif // FITNESS_H
@@ -0,0 +1,293 @@
+#include "hashes.h"
+
+#include <string.h>
+
+#define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define LANES(l) for (int l = 0; l < HASH_LANES; l++)
+
+// ==========================================
+// MD5
+// ==========================================
+
+static const uint32_t MD5_IV[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+static const uint32_t MD5_K[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+static const int MD5_S[4][4] = { { 7, 12, 17, 22 }, { 5, 9, 14, 20 }, { 4, 11, 16, 23 }, { 6, 10, 15, 21 } };
+
+static void md5_compress(hash_lanes_t * state, const hash_lanes_t * w) {
+    hash_lanes_t a, b, c, d;
+    memcpy(a, state[0], sizeof(a));
+    memcpy(b, state[1], sizeof(b));
+    memcpy(c, state[2], sizeof(c));
+    memcpy(d, state[3], sizeof(d));
+
+    for (int i = 0; i < 64; i++) {
+        int round = i >> 4;
+        int s = MD5_S[round][i & 3];
+        int g = round == 0 ? i : round == 1 ? (5 * i + 1) & 15 : round == 2 ? (3 * i + 5) & 15 : (7 * i) & 15;
+        uint32_t k = MD5_K[i];
+
+        // Each round function gets its own lane loop so the branch stays out of the vector body
+        hash_lanes_t f;
+        switch (round) {
+        case 0: LANES(l) f[l] = (b[l] & c[l]) | (~b[l] & d[l]); break;
+        case 1: LANES(l) f[l] = (d[l] & b[l]) | (~d[l] & c[l]); break;
+        case 2: LANES(l) f[l] = b[l] ^ c[l] ^ d[l]; break;
+        default: LANES(l) f[l] = c[l] ^ (b[l] | ~d[l]); break;
+        }
+
+        LANES(l) {
+            uint32_t t = f[l] + a[l] + k + w[g][l];
+            a[l] = d[l];
+            d[l] = c[l];
+            c[l] = b[l];
+            b[l] += ROTL(t, s);
+        }
+    }
+
+    LANES(l) {
+        state[0][l] += a[l];
+        state[1][l] += b[l];
+        state[2][l] += c[l];
+        state[3][l] += d[l];
+    }
+}
+
+// ==========================================
+// SHA-1
+// ==========================================
+
+static const uint32_t SHA1_IV[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+static void sha1_compress(hash_lanes_t * state, const hash_lanes_t * block) {
+    hash_lanes_t w[80];
+    memcpy(w, block, sizeof(hash_lanes_t) * 16);
+    for (int i = 16; i < 80; i++) {
+        LANES(l) {
+            uint32_t x = w[i - 3][l] ^ w[i - 8][l] ^ w[i - 14][l] ^ w[i - 16][l];
+            w[i][l] = ROTL(x, 1);
+        }
+    }
+
+    hash_lanes_t a, b, c, d, e;
+    memcpy(a, state[0], sizeof(a));
+    memcpy(b, state[1], sizeof(b));
+    memcpy(c, state[2], sizeof(c));
+    memcpy(d, state[3], sizeof(d));
+    memcpy(e, state[4], sizeof(e));
+
+    for (int i = 0; i < 80; i++) {
+        hash_lanes_t f;
+        uint32_t k;
+        if (i < 20) {
+            k = 0x5a827999;
+            LANES(l) f[l] = (b[l] & c[l]) | (~b[l] & d[l]);
+        } else if (i < 40) {
+            k = 0x6ed9eba1;
+            LANES(l) f[l] = b[l] ^ c[l] ^ d[l];
+        } else if (i < 60) {
+            k = 0x8f1bbcdc;
+            LANES(l) f[l] = (b[l] & c[l]) | (b[l] & d[l]) | (c[l] & d[l]);
+        } else {
+            k = 0xca62c1d6;
+            LANES(l) f[l] = b[l] ^ c[l] ^ d[l];
+        }
+
+        LANES(l) {
+            uint32_t t = ROTL(a[l], 5) + f[l] + e[l] + k + w[i][l];
+            e[l] = d[l];
+            d[l] = c[l];
+            c[l] = ROTL(b[l], 30);
+            b[l] = a[l];
+            a[l] = t;
+        }
+    }
+
+    LANES(l) {
+        state[0][l] += a[l];
+        state[1][l] += b[l];
+        state[2][l] += c[l];
+        state[3][l] += d[l];
+        state[4][l] += e[l];
+    }
+}
+
+// ==========================================
+// SHA-256
+// ==========================================
+
+static const uint32_t SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static void sha256_compress(hash_lanes_t * state, const hash_lanes_t * block) {
+    hash_lanes_t w[64];
+    memcpy(w, block, sizeof(hash_lanes_t) * 16);
+    for (int i = 16; i < 64; i++) {
+        LANES(l) {
+            uint32_t x = w[i - 15][l], y = w[i - 2][l];
+            uint32_t s0 = ROTR(x, 7) ^ ROTR(x, 18) ^ (x >> 3);
+            uint32_t s1 = ROTR(y, 17) ^ ROTR(y, 19) ^ (y >> 10);
+            w[i][l] = w[i - 16][l] + s0 + w[i - 7][l] + s1;
+        }
+    }
+
+    hash_lanes_t v[8];
+    memcpy(v, state, sizeof(v));
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t k = SHA256_K[i];
+        LANES(l) {
+            uint32_t a = v[0][l], e = v[4][l];
+            uint32_t s1 = ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25);
+            uint32_t ch = (e & v[5][l]) ^ (~e & v[6][l]);
+            uint32_t t1 = v[7][l] + s1 + ch + k + w[i][l];
+            uint32_t s0 = ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22);
+            uint32_t maj = (a & v[1][l]) ^ (a & v[2][l]) ^ (v[1][l] & v[2][l]);
+            v[7][l] = v[6][l];
+            v[6][l] = v[5][l];
+            v[5][l] = e;
+            v[4][l] = v[3][l] + t1;
+            v[3][l] = v[2][l];
+            v[2][l] = v[1][l];
+            v[1][l] = a;
+            v[0][l] = t1 + s0 + maj;
+        }
+    }
+
+    for (int j = 0; j < 8; j++) {
+        LANES(l) state[j][l] += v[j][l];
+    }
+}
+
+const hash_algo_t hash_algos[HASH_ALGO_COUNT] = {
+    { "MD5", 16, 4, 0, MD5_IV, md5_compress },
+    { "SHA1", 20, 5, 1, SHA1_IV, sha1_compress },
+    { "SHA256", 32, 8, 1, SHA256_IV, sha256_compress },
+};
+
+const hash_algo_t * hash_algo_for_hex(size_t hex_len) {
+    for (size_t i = 0; i < HASH_ALGO_COUNT; i++) {
+        if (hash_algos[i].digest_len * 2 == hex_len) return & hash_algos[i];
+    }
+    return NULL;
+}
+
+// Blocks a padded message of len bytes occupies
+static size_t padded_blocks(size_t len) {
+    return (len + 8) / HASH_BLOCK + 1;
+}
+
+// Copies block index b of the padded message into buf
+static void padded_block(const unsigned char * msg, size_t len, size_t b, int big_endian, unsigned char * buf) {
+    size_t start = b * HASH_BLOCK;
+    size_t take = start < len ? len - start : 0;
+    if (take > HASH_BLOCK) take = HASH_BLOCK;
+
+    memcpy(buf, msg + start, take);
+    memset(buf + take, 0, HASH_BLOCK - take);
+    if (start + take == len && take < HASH_BLOCK) buf[take] = 0x80;
+
+    if (b == padded_blocks(len) - 1) {
+        uint64_t bits = (uint64_t) len * 8;
+        for (int i = 0; i < 8; i++) {
+            int shift = big_endian ? 56 - 8 * i : 8 * i;
+            buf[HASH_BLOCK - 8 + i] = (unsigned char)(bits >> shift);
+        }
+    }
+}
+
+void hash_lanes(const hash_algo_t * algo, const unsigned char * const * msgs, const size_t * lens, int count, unsigned char * digests) {
+    hash_lanes_t state[HASH_MAX_WORDS];
+    for (int j = 0; j < algo -> words; j++) {
+        LANES(l) state[j][l] = algo -> iv[j];
+    }
+
+    // Short candidates are one block, so lanes finishing early only happens with long keys
+    size_t blocks = 0;
+    for (int l = 0; l < count; l++) {
+        size_t n = padded_blocks(lens[l]);
+        if (n > blocks) blocks = n;
+    }
+
+    for (size_t b = 0; b < blocks; b++) {
+        hash_lanes_t block[16];
+        memset(block, 0, sizeof(block));
+
+        int active[HASH_LANES] = { 0 };
+        for (int l = 0; l < count; l++) {
+            if (b >= padded_blocks(lens[l])) continue;
+            active[l] = 1;
+
+            unsigned char buf[HASH_BLOCK];
+            padded_block(msgs[l], lens[l], b, algo -> big_endian, buf);
+            for (int i = 0; i < 16; i++) {
+                const unsigned char * p = buf + 4 * i;
+                block[i][l] = algo -> big_endian ?
+                    ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3] :
+                    ((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16) | ((uint32_t) p[1] << 8) | p[0];
+            }
+        }
+
+        hash_lanes_t next[HASH_MAX_WORDS];
+        memcpy(next, state, sizeof(hash_lanes_t) * algo -> words);
+        algo -> compress(next, block);
+        for (int j = 0; j < algo -> words; j++) {
+            LANES(l) if (active[l]) state[j][l] = next[j][l];
+        }
+    }
+
+    for (int l = 0; l < count; l++) {
+        unsigned char * out = digests + l * algo -> digest_len;
+        for (int j = 0; j < algo -> words; j++) {
+            uint32_t x = state[j][l];
+            for (int i = 0; i < 4; i++) {
+                int shift = algo -> big_endian ? 24 - 8 * i : 8 * i;
+                out[4 * j + i] = (unsigned char)(x >> shift);
+            }
+        }
+    }
+}
+
+void hash_one(const hash_algo_t * algo, const unsigned char * msg, size_t len, unsigned char * digest) {
+    hash_lanes(algo, & msg, & len, 1, digest);
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int hex_to_digest(const char * hex, size_t len, unsigned char * out) {
+    for (size_t i = 0; i < len; i++) {
+        int hi = hex_nibble(hex[2 * i]);
+        int lo = hex_nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return -1;
+        out[i] = (unsigned char)((hi << 4) | lo);
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#ifndef HASHES_H
+#define HASHES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Messages hashed side by side. Each round is a loop over the lanes, which the
+// compiler turns into SSE/AVX2/NEON when optimizing, without any intrinsics.
+#define HASH_LANES 8
+#define HASH_BLOCK 64
+#define HASH_MAX_WORDS 8
+#define HASH_MAX_DIGEST 32
+#define HASH_ALGO_COUNT 3
+
+typedef uint32_t hash_lanes_t[HASH_LANES];
+
+typedef struct {
+    const char * name;
+    size_t digest_len;
+    int words;      // state words
+    int big_endian; // message and digest byte order (SHA) vs little endian (MD5)
+    const uint32_t * iv;
+    void (*compress)(hash_lanes_t * state, const hash_lanes_t * block);
+} hash_algo_t;
+
+extern const hash_algo_t hash_algos[HASH_ALGO_COUNT];
+
+// The algorithm whose digest is hex_len hex digits long, or NULL
+const hash_algo_t * hash_algo_for_hex(size_t hex_len);
+
+// Hashes count messages (any length, count <= HASH_LANES) into digests, digest_len bytes apart
+void hash_lanes(const hash_algo_t * algo, const unsigned char * const * msgs, const size_t * lens, int count, unsigned char * digests);
+
+// Single message convenience wrapper around hash_lanes
+void hash_one(const hash_algo_t * algo, const unsigned char * msg, size_t len, unsigned char * digest);
+
+// Parses exactly 2 * len hex digits into out; returns 0 on success
+int hex_to_digest(const char * hex, size_t len, unsigned char * out);
+
+#endif // HASHES_H
@@ -11,8 +11,15 @@
 #include "solvers/solver_registry.h"
 #include "utils.h"
 #include "fitness.h"
+#include "crack.h"
+#include "quadgram.h"
 
 #define PROBABILITY_THRESHOLD 0.01f
+#define KEYS_SHOWN 10 // keys echoed at startup, wordlists can hold millions
+#define ANALYSIS_HINTS 4
+#define ANALYSIS_HINT_MIN 0.5f // analyzer hint before its solver is moved up
+#define AUTO_DEPTH 5 // -a auto without -d: the per-node plans decide how deep each path goes
+#define QUADGRAM_PRIORITY 0.25f // weight of a node's quadgram score in its fitness once a model is loaded
 
 const char * argp_program_version = "ciphter v0.1";
 const char * argp_program_bug_address = "<korbin.deary45@gmail.com>";
@@ -22,7 +29,7 @@ static char args_doc[] = "";
 // Program options
 static struct argp_option options[] = {
     {
-        "task", 't', "TYPE", 0, "Task type: A for analyze, S for solve"
+        "task", 't', "TYPE", 0, "Task type: A for analyze, S for solve, C for crack, B to build a -K hash index into -O, M to build a quadgram model from the input corpus into -O"
     },
     {
         "input", 'i', "STRING", 0, "Inline ciphertext input"
@@ -40,17 +47,26 @@ static struct argp_option options[] = {
         "monitor", 'm', "STRING", 0, "Monitor specific path substring (debug logging)"
     },
     {
-        "algorithms", 'a', "STRING", 0, "Algorithms to use [process only] (default: common)"
+        "algorithms", 'a', "STRING", 0, "Algorithms to use [process only]: comma separated solvers or groups (encodings, classical, keyed, transforms), common, or auto (default: common)"
     },
     {
         "depth", 'd', "INT", 0, "Depth of algorithm combinations [process only] (default: 1)"
     },
     {
-        "keys", 'k', "STRING", 0, "Keys (raw)"
+        "keys", 'k', "STRING", 0, "Key (raw), repeat for several keys"
     },
     {
         "keyfile", 'K', "FILE", 0, "Key file"
     },
+    {
+        "rules", 'r', "STRING", 0, "Mangling rules for cracking, space separated (default: \":\")"
+    },
+    {
+        "index", 'x', "FILE", 0, "Hash index built with -t B, to look up digests"
+    },
+    {
+        "quadgrams", 'q', "FILE", 0, "Quadgram model built with -t M, for English scoring and search priority"
+    },
     {
         "crib", 'c', "STRING", 0, "Known string to search for (filters output)"
     },
@@ -78,13 +94,18 @@ struct arguments {
     sds input;
     char * algorithms;
     int depth;
-    sds keys;
+    keychain_t keychain;
+    char * keyfile; // last -K, the wordlist an index is built from
+    char * index_file;
+    char * model_file;
+    char * rules;
     char * crib;
     int probability_threshold;
     int english_threshold; // -1 if disabled
     char * monitor_path; // NULL if disabled
     char * output_file;
     int p_set;
+    int d_set;
     int silent;
     int timeout;
     int max_heap_size;
@@ -100,6 +121,12 @@ static error_t parse_opt(int key, char * arg, struct argp_state * state) {
             arguments -> subcommand = "analyze";
         else if (strcasecmp(arg, "S") == 0)
             arguments -> subcommand = "solve";
+        else if (strcasecmp(arg, "C") == 0)
+            arguments -> subcommand = "crack";
+        else if (strcasecmp(arg, "B") == 0)
+            arguments -> subcommand = "index";
+        else if (strcasecmp(arg, "M") == 0)
+            arguments -> subcommand = "model";
         else
             argp_error(state, "Unknown task type: %s", arg);
         break;
@@ -144,29 +171,30 @@ static error_t parse_opt(int key, char * arg, struct argp_state * state) {
         arguments -> algorithms = arg;
         break;
     case 'd':
+        arguments -> d_set = 1;
         arguments -> depth = atoi(arg);
         break;
     case 'k':
-        arguments -> keys = sdscat(arguments -> keys, arg);
-        arguments -> keys = sdscat(arguments -> keys, "|");
+        // argv outlives the search, so the key is viewed in place
+        if (keychain_add( & arguments -> keychain, arg, strlen(arg)) != 0) {
+            argp_error(state, "Out of memory adding key: %s", arg);
+        }
         break;
-    case 'K': {
-        FILE * f = fopen(arg, "r");
-        if (f) {
-            char line[1024];
-            while (fgets(line, sizeof(line), f)) {
-                line[strcspn(line, "\r\n")] = 0; // Strip newline
-                if (strlen(line) > 0) {
-                    arguments -> keys = sdscat(arguments -> keys, line);
-                    arguments -> keys = sdscat(arguments -> keys, "|");
-                }
-            }
-            fclose(f);
-        } else {
-            argp_error(state, "Could not open key file: %s", arg);
+    case 'K':
+        if (keychain_map_file( & arguments -> keychain, arg) != 0) {
+            argp_error(state, "Could not read key file: %s", arg);
         }
+        arguments -> keyfile = arg;
+        break;
+    case 'x':
+        arguments -> index_file = arg;
+        break;
+    case 'q':
+        arguments -> model_file = arg;
+        break;
+    case 'r':
+        arguments -> rules = arg;
         break;
-    }
     case 'c':
         arguments -> crib = arg;
         break;
@@ -202,16 +230,25 @@ static error_t parse_opt(int key, char * arg, struct argp_state * state) {
     return 0;
 }
 
-void analyze(sds input, float probability_threshold) {
+void analyze(sds input, float probability_threshold, const hash_index_t * index) {
     printf("[INFO] Running analysis on input: \"%s\"\n", input);
     int found = 0;
+    analysis_profile_t profile;
+    analysis_profile_build(input, & profile);
     for (size_t i = 0; i < analyzers_count; ++i) {
         analyzer_t analyzer = analyzers[i];
-        analysis_result_t result = analyzer.fn(input);
+        analysis_result_t result = analyzer.fn(input, & profile);
         if (result.probability < probability_threshold) continue;
         printf("[%.0f%%]\t [%s] %s\n", result.probability * 100, analyzer.label, result.message);
         found++;
     }
+
+    const char * algo;
+    key_view_t plain;
+    if (hash_index_lookup(index, input, sdslen(input), & algo, & plain)) {
+        printf("[100%%]\t [%s] Found in index: \"%.*s\"\n", algo, (int) plain.len, plain.data);
+        found++;
+    }
     if (!found) {
         printf("[INFO] No high-probability analysis results found.\n");
     }
@@ -269,8 +306,58 @@ void prune_heap(heap * h, int max_size) {
     h -> active_entries = max_size;
 }
 
+// Frontier floor: the best max_heap_size priorities among the queued nodes and the children offered since,
+// kept in a min-heap. Once it is full, its root is what a child must reach to survive the next prune.
+typedef struct {
+    float * priorities;
+    int len;
+    int cap;
+} frontier_t;
+
+static void frontier_sift_down(frontier_t * f, int i) {
+    for (;;) {
+        int least = i, l = 2 * i + 1, r = l + 1;
+        if (l < f -> len && f -> priorities[l] < f -> priorities[least]) least = l;
+        if (r < f -> len && f -> priorities[r] < f -> priorities[least]) least = r;
+        if (least == i) return;
+        float t = f -> priorities[i];
+        f -> priorities[i] = f -> priorities[least];
+        f -> priorities[least] = t;
+        i = least;
+    }
+}
+
+// Starts over from the queued nodes
+static void frontier_build(frontier_t * f, const heap * h) {
+    f -> len = 0;
+    for (int i = 0; i < h -> active_entries && f -> len < f -> cap; i++) {
+        const solver_output_t * node = h -> table[i].key;
+        f -> priorities[f -> len++] = output_priority(node -> cumulative_fitness, node -> depth);
+    }
+    for (int i = f -> len / 2 - 1; i >= 0; i--) frontier_sift_down(f, i);
+}
+
+static float frontier_floor(const frontier_t * f) {
+    return f -> len == f -> cap ? f -> priorities[0] : -INFINITY;
+}
+
+// Records a queued child. Ties with the floor leave it alone, so the floor never overshoots.
+static void frontier_offer(frontier_t * f, float priority) {
+    if (f -> len < f -> cap) {
+        int i = f -> len++;
+        while (i > 0 && f -> priorities[(i - 1) / 2] > priority) {
+            f -> priorities[i] = f -> priorities[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        f -> priorities[i] = priority;
+    } else if (priority > f -> priorities[0]) {
+        f -> priorities[0] = priority;
+        frontier_sift_down(f, 0);
+    }
+}
+
 void solve(sds input, float fitness_threshold,
-    const char * algorithms, int depth, keychain_t * keychain,
+    solver_mask_t enabled, int auto_plan, int depth, keychain_t * keychain,
     const char * crib, float english_threshold,
     const char * monitor_path, char * output_file, int p_set, int silent, int timeout, int max_heap_size) {
     sds displayed_input = sdsdup(input);
@@ -293,13 +380,43 @@ void solve(sds input, float fitness_threshold,
     }
 
     // Parse algorithm string or use default
-    size_t solvers_count = 0;
-    solver_t * solvers = get_solvers(algorithms, & solvers_count);
+    // The selection is a mask over the whole registry
+    solver_t * registry = solvers;
+    size_t registry_count = solvers_count;
+
+    // Keyed solvers the analyzers point at (IoC, periodicity) run first
+    analysis_result_t hints[ANALYSIS_HINTS];
+    size_t hint_count = analysis_suggest(input, ANALYSIS_HINT_MIN, hints, ANALYSIS_HINTS);
+    size_t * order = malloc(sizeof(size_t) * (registry_count + 1));
+    solver_mask_t placed = 0;
+    size_t ordered = 0;
+    for (size_t h = 0; h < hint_count; h++) {
+        for (size_t i = 0; i < registry_count; i++) {
+            if (strcmp(registry[i].label, hints[h].solver) != 0 || (placed & SOLVER_BIT(i)) || !(enabled & SOLVER_BIT(i))) continue;
+            placed |= SOLVER_BIT(i);
+            order[ordered++] = i;
+
+            // Report the period when any of the analyzers behind this solver measured one
+            int period = 0;
+            for (size_t k = 0; k < hint_count && !period; k++) {
+                if (strcmp(hints[k].solver, hints[h].solver) == 0) period = hints[k].period;
+            }
+            if (period > 0) printf("[INFO] Analysis suggests %s (period %d)\n", hints[h].solver, period);
+            else printf("[INFO] Analysis suggests %s\n", hints[h].solver);
+        }
+    }
+    for (size_t i = 0; i < registry_count; i++) {
+        if (!(placed & SOLVER_BIT(i))) order[ordered++] = i;
+    }
 
-    printf("[INFO] Loaded %zu algorithms: ", solvers_count);
-    for (size_t i = 0; i < solvers_count; ++i) {
-        printf("%s", solvers[i].label);
-        if (i < solvers_count - 1) printf(", ");
+    size_t enabled_count = 0;
+    for (size_t i = 0; i < registry_count; i++) enabled_count += (enabled & SOLVER_BIT(i)) != 0;
+    printf("[INFO] Loaded %zu algorithms%s: ", enabled_count, auto_plan ? " (auto planned per node)" : "");
+    int first = 1;
+    for (size_t i = 0; i < ordered; ++i) {
+        if (!(enabled & SOLVER_BIT(order[i]))) continue;
+        printf("%s%s", first ? "" : ", ", registry[order[i]].label);
+        first = 0;
     }
     printf("\n");
 
@@ -311,10 +428,19 @@ void solve(sds input, float fitness_threshold,
         .method = sdsnew("CIPHERTEXT"),
         .data = sdsdup(input),
         .depth = 0,
-        .last_solver = NULL
+        .last_solver = NULL,
+        .depth_limit = depth
     };
 
     int is_eng_set = english_threshold >= 0.0f;
+    int use_quadgrams = quadgram_log_probs() != NULL;
+
+    // A child below the frontier floor would be pruned right away: it is dropped unqueued, and its quadgram
+    // score stops as soon as it can no longer reach the floor
+    frontier_t frontier = {
+        .priorities = max_heap_size > 0 ? malloc(sizeof(float) * max_heap_size) : NULL,
+        .cap = max_heap_size
+    };
 
     heap path_heap = {
         0
@@ -352,6 +478,19 @@ void solve(sds input, float fitness_threshold,
             break;
         }
 
+        // Finish lazy outputs once popped: scoring, printing, ranking and expansion all need the whole text.
+        // Nodes pruned before they get here never pay for it.
+        if (current -> finish) {
+            sds full = current -> finish(current -> pending);
+            if (full) {
+                sdsfree(current -> data);
+                current -> data = full;
+            }
+            sdsfree(current -> pending);
+            current -> pending = NULL;
+            current -> finish = NULL;
+        }
+
         float eng_score = 0.0f;
         if (english_threshold >= 0.0f) {
             eng_score = score_english_detailed(current -> data, sdslen(current -> data));
@@ -409,6 +548,30 @@ void solve(sds input, float fitness_threshold,
             continue;
         }
 
+        // -a auto: the node's own plan narrows the solvers and may stop its path early
+        solver_mask_t node_mask = enabled;
+        int depth_limit = current -> depth_limit;
+        if (auto_plan) {
+            solver_plan_t plan = plan_solvers(current -> data, current -> depth, enabled, keychain);
+            node_mask = plan.mask;
+            // A recognizable encoding is progress and renews the budget, guesses on top of guesses only narrow it
+            if (plan.encoded || current -> depth + plan.remaining_depth < depth_limit) depth_limit = current -> depth + plan.remaining_depth;
+            if (verbose_flag) {
+                printf("[DEBUG] [PLAN] %s: %d more layer(s), solvers:", current -> method, plan.remaining_depth);
+                for (size_t i = 0; i < registry_count; i++) {
+                    if (node_mask & SOLVER_BIT(i)) printf(" %s", registry[i].label);
+                }
+                printf("\n");
+            }
+            if (current -> depth >= depth_limit) {
+                if (current != & input_res) {
+                    free_output(current);
+                    free(current);
+                }
+                continue;
+            }
+        }
+
         if (max_heap_size > 0) {
             if(heap_size(&path_heap) > max_heap_size) {
                 // debug_log("Pruning heap from %zu to %d\n", heap_size( & path_heap), max_heap_size);
@@ -416,19 +579,16 @@ void solve(sds input, float fitness_threshold,
             }
         }
 
-        // Check for non-printable characters
-        int is_dirty = 0;
-        size_t cur_len = sdslen(current->data);
-        for (size_t i = 0; i < cur_len; i++) {
-            unsigned char c = (unsigned char)current->data[i];
-            if (!isprint(c) && c != '\n' && c != '\r' && c != '\t') {
-                is_dirty = 1;
-                break;
-            }
-        }
+        // One scan of the node serves every solver: transpositions and byte maps score from these
+        text_stats_t stats;
+        text_stats_gather(current -> data, sdslen(current -> data), & stats);
+        int is_dirty = stats.non_printable > 0;
+
+        if (frontier.cap > 0) frontier_build(& frontier, & path_heap);
 
-        for (size_t i = 0; i < solvers_count; ++i) {
-            solver_t solver = solvers[i];
+        for (size_t i = 0; i < registry_count; ++i) {
+            if (!(node_mask & SOLVER_BIT(order[i]))) continue;
+            solver_t solver = registry[order[i]];
 
             if (is_dirty && !solver.handles_non_printable) {
                 continue;
@@ -440,19 +600,41 @@ void solve(sds input, float fitness_threshold,
 
             // printf("[SOLVER] test: %s\n", solver.label);
 
-            solver_result_t result = solver.fn(current -> data, keychain);
+            solver_result_t result = solver.fn(current -> data, keychain, & stats);
 
             for (size_t j = 0; j < result.len; ++j) {
                 if (strcmp(current -> data, result.outputs[j].data) == 0) {
                     continue;
                 }
 
+                float fitness = result.outputs[j].fitness;
+                float cumulative_fitness = current -> cumulative_fitness + fitness;
+                int crib_hit = crib && strstr(result.outputs[j].data, crib) != NULL;
+                float cutoff = crib_hit || monitor_path ? -INFINITY : frontier_floor(& frontier);
+                int bounded = cutoff > -INFINITY;
+
+                // With a model loaded, English-looking letters move up the queue
+                if (use_quadgrams) {
+                    float quad;
+                    if (bounded) {
+                        // Smallest score that keeps the child at or above the floor
+                        float need = (cutoff * (current -> depth + 2.0f) - cumulative_fitness) / QUADGRAM_PRIORITY;
+                        quad = score_quadgrams_bounded(result.outputs[j].data, sdslen(result.outputs[j].data), need);
+                        if (quad < 0.0f) continue;
+                    } else {
+                        quad = score_quadgrams(result.outputs[j].data, sdslen(result.outputs[j].data));
+                    }
+                    fitness += QUADGRAM_PRIORITY * quad;
+                    cumulative_fitness += QUADGRAM_PRIORITY * quad;
+                }
+                if (bounded && output_priority(cumulative_fitness, current -> depth + 1) < cutoff) continue;
+
                 solver_output_t * saved_output = malloc(sizeof(solver_output_t));
-                saved_output -> fitness = result.outputs[j].fitness;
-                saved_output -> cumulative_fitness = current -> cumulative_fitness + result.outputs[j].fitness;
+                saved_output -> fitness = fitness;
+                saved_output -> cumulative_fitness = cumulative_fitness;
 
                 // Prioritize crib matches immediately
-                if (crib && strstr(result.outputs[j].data, crib) != NULL) {
+                if (crib_hit) {
                     saved_output -> fitness = 1.0f; // Max priority
                     saved_output -> cumulative_fitness += 1.0f; // Also boost accumulator
                 }
@@ -461,6 +643,14 @@ void solve(sds input, float fitness_threshold,
                 saved_output -> data = sdsdup(result.outputs[j].data);
                 saved_output -> depth = current -> depth + 1;
                 saved_output -> last_solver = solver.label;
+                saved_output -> depth_limit = depth_limit;
+                saved_output -> pending = NULL;
+                saved_output -> finish = NULL;
+                if (solver.lazy_outputs) {
+                    saved_output -> pending = result.outputs[j].pending;
+                    saved_output -> finish = result.outputs[j].finish;
+                    result.outputs[j].pending = NULL;
+                }
 
                 // Monitor logs
                 if (monitor_path && strstr(sdscat(sdsnew(saved_output -> method), "$"), monitor_path) != NULL) {
@@ -473,12 +663,14 @@ void solve(sds input, float fitness_threshold,
                 }
 
                 heap_insert( & path_heap, saved_output, saved_output);
+                if (frontier.cap > 0) frontier_offer(& frontier, output_priority(saved_output -> cumulative_fitness, saved_output -> depth));
             }
             
             // CLEANUP: Free the result structure and its contents
             for(size_t j=0; j<result.len; j++) {
                 sdsfree(result.outputs[j].data);
                 sdsfree(result.outputs[j].method);
+                if (solver.lazy_outputs) sdsfree(result.outputs[j].pending);
             }
             if (result.outputs) free(result.outputs);
         }
@@ -496,8 +688,10 @@ void solve(sds input, float fitness_threshold,
         }
     } // End of while loop
 
+    free(frontier.priorities);
     heap_foreach(&path_heap, free_heap_output);
     heap_destroy( & path_heap);
+    free(order);
     
     free_output(&input_res);
 
@@ -523,7 +717,7 @@ int main(int argc, char * argv[]) {
         .input = NULL,
         .algorithms = "common",
         .depth = 1,
-        .keys = sdsnew(""),
+        .keychain = { 0 },
         .probability_threshold = (int)(PROBABILITY_THRESHOLD * 100),
         .english_threshold = -1,
         .output_file = NULL,
@@ -542,54 +736,103 @@ int main(int argc, char * argv[]) {
     argp_parse( & argp, argc, argv, 0, 0, & args);
 
     // Dispatch logic
-    if (!args.input) {
-        fprintf(stderr, "ERROR: Missing required input.\n");
+    if (!args.subcommand) {
+        fprintf(stderr, "ERROR: Missing required subcommand.\n");
         argp_help( & argp, stderr, ARGP_HELP_STD_ERR, argv[0]);
         return 1;
     }
-    if (!args.subcommand) {
-        fprintf(stderr, "ERROR: Missing required subcommand.\n");
+    if (strcmp(args.subcommand, "index") == 0) {
+        if (!args.output_file) {
+            fprintf(stderr, "ERROR: Missing index output file (-O).\n");
+            return 1;
+        }
+        int status = hash_index_build( & args.keychain, args.keyfile, args.output_file) == 0 ? 0 : 1;
+        if (args.input) sdsfree(args.input);
+        keychain_free( & args.keychain);
+        return status;
+    }
+    if (!args.input) {
+        fprintf(stderr, "ERROR: Missing required input.\n");
         argp_help( & argp, stderr, ARGP_HELP_STD_ERR, argv[0]);
         return 1;
     }
+    if (strcmp(args.subcommand, "model") == 0) {
+        if (!args.output_file) {
+            fprintf(stderr, "ERROR: Missing model output file (-O).\n");
+            return 1;
+        }
+        int status = quadgram_model_build(args.input, sdslen(args.input), args.output_file) == 0 ? 0 : 1;
+        sdsfree(args.input);
+        keychain_free( & args.keychain);
+        return status;
+    }
 
+    hash_index_t * index = NULL;
+    if (args.index_file) {
+        index = hash_index_open(args.index_file);
+        if (!index) return 1;
+        args.keychain.index = index;
+    }
+
+    quadgram_model_t * model = NULL;
+    if (args.model_file) {
+        model = quadgram_model_open(args.model_file);
+        if (!model) {
+            hash_index_close(index);
+            return 1;
+        }
+        quadgram_model_use(model);
+    }
+
+    int status = 0;
     if (strcmp(args.subcommand, "analyze") == 0) {
-        analyze(args.input, args.probability_threshold / 100.0f);
+        analyze(args.input, args.probability_threshold / 100.0f, index);
         args.input = NULL; // analyze frees it
     } else if (strcmp(args.subcommand, "solve") == 0) {
-        // split keys by | into array
-        sds raw_keys = args.keys;
-        int count = 0;
-        sds * tokens = sdssplitlen(raw_keys, sdslen(raw_keys), "|", 1, & count);
+        keychain_t * keychain = & args.keychain;
+        keychain -> crib = args.crib;
+
+        solver_mask_t enabled;
+        int auto_plan;
+        size_t registry_count;
+        if (!get_solvers(args.algorithms, & registry_count, & enabled, & auto_plan)) {
+            sdsfree(args.input);
+            keychain_free( & args.keychain);
+            hash_index_close(index);
+            quadgram_model_close(model);
+            return 1;
+        }
+        if (auto_plan && !args.d_set) args.depth = AUTO_DEPTH;
 
         debug_log("Algorithms: %s\n", args.algorithms);
         debug_log("Depth: %d\n", args.depth);
 
-        if (count == 0) {
+        if (keychain -> len == 0) {
             printf("[INFO] No keys provided.\n");
         } else {
             printf("[INFO] Keys: ");
-            for (int i = 0; i < count; i++) {
-                printf("%s / ", tokens[i]);
+            for (int i = 0; i < keychain -> len && i < KEYS_SHOWN; i++) {
+                printf("%.*s / ", (int) keychain -> keys[i].len, keychain -> keys[i].data);
             }
+            if (keychain -> len > KEYS_SHOWN) printf("... (%d keys)", keychain -> len);
             printf("\n");
         }
 
-        keychain_t keychain = {
-            .len = count,
-            .keys = tokens
-        };
-
         debug_log("Probability Threshold: %f\n", args.probability_threshold / 100.0f);
         debug_log("English Threshold: %f\n", args.english_threshold / 100.0f);
         debug_log("Max Heap Size: %d\n", args.max_heap_size);
 
-        solve(args.input, args.probability_threshold / 100.0f, args.algorithms, args.depth, & keychain, args.crib, args.english_threshold / 100.0f, args.monitor_path, args.output_file, args.p_set, args.silent, args.timeout, args.max_heap_size);
+        solve(args.input, args.probability_threshold / 100.0f, enabled, auto_plan, args.depth, keychain, args.crib, args.english_threshold / 100.0f, args.monitor_path, args.output_file, args.p_set, args.silent, args.timeout, args.max_heap_size);
         args.input = NULL; // solve frees it
-        sdsfreesplitres(tokens, count);
+    } else if (strcmp(args.subcommand, "crack") == 0) {
+        if (crack(args.input, & args.keychain, args.rules) < 0) {
+            status = 1;
+        }
     }
 
     if (args.input) sdsfree(args.input);
-    sdsfree(args.keys);
-    return 0;
+    keychain_free( & args.keychain);
+    hash_index_close(index);
+    quadgram_model_close(model);
+    return status;
 }
@@ -0,0 +1,139 @@
+#include "quadgram.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "fitness.h"
+#include "utils.h"
+
+// File layout, native byte order: header, then QUADGRAM_SPACE floats indexed by four letters in base 26 (a = 0)
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t order;       // letters per n-gram, always 4 for now
+    float english_mean;   // mean log-probability per quadgram over the corpus itself
+    float random_mean;    // ... and over uniformly random letters
+    uint32_t reserved;
+    uint64_t quadgrams;   // quadgrams counted
+} quadgram_header_t;
+
+struct quadgram_model {
+    void * map;
+    size_t map_len;
+    const quadgram_header_t * header;
+    const float * logp;
+};
+
+int quadgram_model_build(const char * text, size_t len, const char * path) {
+    const unsigned char * corpus = (const unsigned char *) text;
+    uint64_t * counts = calloc(QUADGRAM_SPACE, sizeof(uint64_t));
+    float * logp = malloc(sizeof(float) * QUADGRAM_SPACE);
+    if (!counts || !logp) {
+        free(counts);
+        free(logp);
+        return -1;
+    }
+
+    // Rolling base-26 index over the letters; the oldest letter drops out as the next one comes in
+    uint64_t total = 0;
+    uint32_t index = 0;
+    int run = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!isalpha(corpus[i])) continue;
+        index = (index % (26 * 26 * 26)) * 26 + (tolower(corpus[i]) - 'a');
+        if (run < 3) {
+            run++;
+            continue;
+        }
+        counts[index]++;
+        total++;
+    }
+
+    if (total < QUADGRAM_MIN_CORPUS) {
+        fprintf(stderr, "ERROR: Corpus too small: %llu quadgrams, need at least %d\n", (unsigned long long) total, QUADGRAM_MIN_CORPUS);
+        free(counts);
+        free(logp);
+        return -1;
+    }
+
+    // Unseen quadgrams share a floor rather than -inf, so one odd quadgram can't sink a candidate
+    double floor_logp = log(QUADGRAM_FLOOR_COUNT / total);
+    double english = 0.0, random = 0.0;
+    for (uint32_t q = 0; q < QUADGRAM_SPACE; q++) {
+        double p = counts[q] ? log((double) counts[q] / total) : floor_logp;
+        logp[q] = (float) p;
+        english += counts[q] * p;
+        random += p;
+    }
+
+    quadgram_header_t header = {
+        .magic = QUADGRAM_MODEL_MAGIC,
+        .version = QUADGRAM_MODEL_VERSION,
+        .order = 4,
+        .english_mean = (float)(english / total),
+        .random_mean = (float)(random / QUADGRAM_SPACE),
+        .quadgrams = total
+    };
+
+    int status = -1;
+    FILE * f = fopen(path, "wb");
+    if (f) {
+        int ok = fwrite( & header, sizeof(header), 1, f) == 1 &&
+            fwrite(logp, sizeof(float), QUADGRAM_SPACE, f) == QUADGRAM_SPACE;
+        if (fclose(f) == 0 && ok) status = 0;
+    }
+    if (status == 0) {
+        printf("[INFO] Wrote %s (%llu quadgrams, English %.2f / random %.2f per quadgram)\n",
+            path, (unsigned long long) total, header.english_mean, header.random_mean);
+    } else {
+        fprintf(stderr, "ERROR: Could not write model file: %s\n", path);
+    }
+
+    free(counts);
+    free(logp);
+    return status;
+}
+
+quadgram_model_t * quadgram_model_open(const char * path) {
+    size_t map_len = 0;
+    void * map = map_file(path, & map_len, 0);
+    const quadgram_header_t * header = map;
+    if (!map || map_len < sizeof(quadgram_header_t) ||
+        memcmp(header -> magic, QUADGRAM_MODEL_MAGIC, 4) != 0 || header -> version != QUADGRAM_MODEL_VERSION || header -> order != 4) {
+        fprintf(stderr, "ERROR: Not a ciphter quadgram model (version %d): %s\n", QUADGRAM_MODEL_VERSION, path);
+        if (map) unmap_file(map, map_len);
+        return NULL;
+    }
+    if (map_len < sizeof(quadgram_header_t) + sizeof(float) * QUADGRAM_SPACE) {
+        fprintf(stderr, "ERROR: Truncated quadgram model: %s\n", path);
+        unmap_file(map, map_len);
+        return NULL;
+    }
+
+    quadgram_model_t * model = calloc(1, sizeof(quadgram_model_t));
+    if (!model) {
+        unmap_file(map, map_len);
+        return NULL;
+    }
+    model -> map = map;
+    model -> map_len = map_len;
+    model -> header = header;
+    model -> logp = (const float *)((const char *) map + sizeof(quadgram_header_t));
+    return model;
+}
+
+void quadgram_model_close(quadgram_model_t * model) {
+    if (!model) return;
+    set_quadgram_table(NULL, 0.0f, 0.0f);
+    unmap_file(model -> map, model -> map_len);
+    free(model);
+}
+
+void quadgram_model_use(const quadgram_model_t * model) {
+    if (!model) return;
+    set_quadgram_table(model -> logp, model -> header -> english_mean, model -> header -> random_mean);
+}
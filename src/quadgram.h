@@ -0,0 +1,27 @@
+#ifndef QUADGRAM_H
+#define QUADGRAM_H
+
+#include <stddef.h>
+
+#define QUADGRAM_MODEL_MAGIC "CHQG"
+#define QUADGRAM_MODEL_VERSION 1
+#define QUADGRAM_SPACE (26 * 26 * 26 * 26)
+#define QUADGRAM_FLOOR_COUNT 0.01 // pseudo-count given to quadgrams the corpus never shows
+#define QUADGRAM_MIN_CORPUS 10000 // quadgrams below which the counts are too sparse to rank anything
+
+// Letter quadgram model of English: 26^4 log-probabilities, built once from a corpus and memory-mapped,
+// so loading costs nothing and the table is shared between processes.
+typedef struct quadgram_model quadgram_model_t;
+
+// Counts the letter quadgrams of an English corpus (case folded, everything else skipped) into a model file at path.
+// Returns 0 on success.
+int quadgram_model_build(const char * text, size_t len, const char * path);
+
+// Maps a model file; NULL (with a message) if it is missing, truncated or another version
+quadgram_model_t * quadgram_model_open(const char * path);
+void quadgram_model_close(quadgram_model_t * model);
+
+// Makes the model the quadgram table of the fitness functions (score_quadgrams and everything built on it)
+void quadgram_model_use(const quadgram_model_t * model);
+
+#endif // QUADGRAM_H
@@ -2,6 +2,10 @@
 
 #include <string.h>
 
+#include <strings.h>
+
+#include <math.h>
+
 #include "../../lib/sds/sds.h"
 
 #include "solver_registry.h"
@@ -10,44 +14,149 @@
 
 #include "../fitness.h"
 
-#define solver_fn(fn_label) static solver_result_t solve_ ## fn_label(sds input, keychain_t * keychain)
-#define SOLVER(fn_label, p_score, consecutive, non_printable) { .label = #fn_label, .popularity = p_score, .prevent_consecutive = consecutive, .handles_non_printable = non_printable, .fn = solve_ ## fn_label }
+#include "../crack.h"
+
+#include "../analyzers/analysis_registry.h"
+
+#define solver_fn(fn_label) static solver_result_t solve_ ## fn_label(sds input, keychain_t * keychain, const text_stats_t * stats)
+#define SOLVER(fn_label, p_score, consecutive, non_printable, group) { .label = #fn_label, .popularity = p_score, .prevent_consecutive = consecutive, .handles_non_printable = non_printable, .groups = SOLVER_GROUP_ ## group, .fn = solve_ ## fn_label }
+// Solvers whose outputs may carry a pending remainder (see solver_output_t)
+#define LAZY_SOLVER(fn_label, p_score, consecutive, non_printable, group) { .label = #fn_label, .popularity = p_score, .prevent_consecutive = consecutive, .handles_non_printable = non_printable, .groups = SOLVER_GROUP_ ## group, .lazy_outputs = 1, .fn = solve_ ## fn_label }
 #define ALPHABET_SIZE 26
 
 // Solver Constants
 #define VIGENERE_THRESHOLD 0.01f
+#define VIGENERE_MIN_LETTERS 40
+#define VIGENERE_MIN_COLUMN 6
+#define VIGENERE_MAX_PERIOD 20
+#define VIGENERE_MAX_IOC 0.060f
+#define VIGENERE_TOP_PERIODS 3
+#define VIGENERE_ENGLISH_IOC 0.060f
+#define VIGENERE_KASISKI_WEIGHT 0.01f
+
+// Rail Fence
+#define RAILFENCE_MAX_RAILS 64
+#define RAILFENCE_CHARS_PER_RAIL 32
+#define RAILFENCE_CACHE_SLOTS 4096
+#define RAILFENCE_CACHE_BYTES (32 * 1024 * 1024)
+
+// Columnar transposition
+#define COLUMNAR_MIN_LEN 16
+#define COLUMNAR_MAX_CHI 1.0f // per letter
+#define COLUMNAR_EXHAUSTIVE_MAX 6
+#define COLUMNAR_MAX_WIDTH 12
+#define COLUMNAR_RESTARTS 8
+#define COLUMNAR_TOP_KEYS 3
+
+// Substitution
+#define SUBSTITUTION_NGRAM 2      // bigrams from the built-in table
+#define SUBSTITUTION_QUADGRAM 4   // n-gram length once a quadgram model is loaded
+#define SUBSTITUTION_MIN_LETTERS 60
+#define SUBSTITUTION_MIN_IOC 0.055f
+#define SUBSTITUTION_MIN_CHI 1.0f // per letter, below this the frequencies already read as English
+#define SUBSTITUTION_RESTARTS 8
+#define SUBSTITUTION_ITERATIONS 20000
+#define SUBSTITUTION_PERTURB 10
+#define SUBSTITUTION_T0 4.0f
+#define SUBSTITUTION_QUADGRAM_T0 20.0f // quadgram swaps move the score several times further
+#define SUBSTITUTION_TOP_KEYS 2
+
+// XOR key recovery
+#define XOR_MIN_LEN 8
+#define XOR_MIN_SCORE 0.3f
+#define XOR_TOP_KEYS 3
+#define XOR_TOP_KEYSIZES 3
+#define XOR_MAX_KEYSIZE 40
+#define XOR_HAMMING_BLOCKS 8
+
+// Radix decoders drop outputs shorter than this fraction of their input
+#define ENCODING_MIN_RATIO 0.5f
+
+// Compressed payloads are scored from an inflated prefix and only finished when expanded.
+// Deflate cannot expand past ~1032:1, anything claiming more is a bomb or garbage.
+#define INFLATE_PREFIX 4096
+#define INFLATE_MAX_OUTPUT (16 * 1024 * 1024)
+#define INFLATE_MAX_RATIO 1032
+
+// Crib dragging: a key is read off wherever the crib confirms it repeats for this many more symbols
+#define CRIB_MIN_REPEAT 3
+#define CRIB_MAX_LEN 256
+#define CRIB_MAX_CANDIDATES 64
+#define CRIB_TOP_KEYS 3
+#define CRIB_PARALLEL_MIN (1 << 16) // offsets x crib length before dragging goes parallel
+
+// Keyed solvers score every -k/-K key from a streamed histogram and only build their best outputs
+#define KEYED_TOP_K 8
+#define KEYED_PARALLEL_MIN (1 << 20) // keys x input bytes before the scan goes parallel
+
+// Rotation solvers emit only their best shifts once enough of the text rotates to rank them
+#define ROTATION_MIN_LETTERS 20
+
+// BASE converts numerals of any length with 32-bit limbs; longer inputs are left to the encoding solvers
+#define BASE_MAX_DIGITS 8192
+// Longer decimals are only ever an intermediate for the byte payload, which is emitted directly
+#define BASE_MAX_DECIMAL 40
 
 // Affine, Railfence, Vigenere fitness have lower base scores because its outputs always have only printable characters
 #define SIMPLE_CIPHER_FITNESS_FACTOR 0.9f
 #define PENALTY_FACTOR 0.01f
 
-typedef struct {
-    const char * morse;
-    char alpha;
-} morse_map_t;
-
-static morse_map_t morse_table[] = {
-    {".-", 'A'}, {"-...", 'B'}, {"-.-.", 'C'}, {"-..", 'D'}, {".", 'E'},
-    {"..-.", 'F'}, {"--.", 'G'}, {"....", 'H'}, {"..", 'I'}, {".---", 'J'},
-    {"-.-", 'K'}, {".-..", 'L'}, {"--", 'M'}, {"-.", 'N'}, {"---", 'O'},
-    {".--.", 'P'}, {"--.-", 'Q'}, {".-.", 'R'}, {"...", 'S'}, {"-", 'T'},
-    {"..-", 'U'}, {"...-", 'V'}, {".--", 'W'}, {"-..-", 'X'}, {"-.--", 'Y'},
-    {"--..", 'Z'}, {"-----", '0'}, {".----", '1'}, {"..---", '2'}, {"...--", '3'},
-    {"....-", '4'}, {".....", '5'}, {"-....", '6'}, {"--...", '7'}, {"---..", '8'},
-    {"----.", '9'}, {".-.-.-", '.'}, {"--..--", ','}, {"---...", ':'}, {"..--..", '?'},
-    {".----.", '\''}, {"-....-", '-'}, {"-..-.", '/'}, {"-.--.", '('}, {"-.--.-", ')'},
-    {".-..-.", '"'}, {".--.-.", '@'}, {"-...-", '='}, {"---...", ';'}
+// Morse symbols index a binary tree: a leading 1 bit marks the length, then one bit per symbol
+// (dot = 0, dash = 1, first symbol highest). Codes are at most 6 symbols, so 128 slots cover them all.
+#define MORSE_MAX_SYMBOLS 6
+
+// -a auto planning
+#define AUTO_PLAINTEXT_SCORE 0.6f  // ENGLISH analyzer probability at which a node is left as it is
+#define AUTO_PLAINTEXT_MIN_LEN 16
+#define AUTO_MIN_LETTER_SHARE 0.5f // letters among non-whitespace before classical ciphers are worth trying
+#define AUTO_POLY_IOC 0.060f       // letter IoC below which polyalphabetic key recovery runs
+#define AUTO_ENCODING_DEPTH 4      // encodings nest, an encoded node may be several layers from the end
+#define AUTO_CIPHER_DEPTH 2        // a cipher layer, then perhaps one more
+#define AUTO_BINARY_DEPTH 2        // raw bytes: a keyed/compressed layer, then perhaps one more
+
+static const char MORSE_DECODE[128] = {
+    0, 0, 'E', 'T', 'I', 'A', 'N', 'M', 'S', 'U', 'R', 'W', 'D', 'K', 'G', 'O',
+    'H', 'V', 'F', 0, 'L', 0, 'P', 'J', 'B', 'X', 'C', 'Y', 'Z', 'Q', 0, 0,
+    '5', '4', 0, '3', 0, 0, 0, '2', 0, 0, 0, 0, 0, 0, 0, '1',
+    '6', '=', '/', 0, 0, 0, '(', 0, '7', 0, 0, 0, '8', 0, '9', '0',
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '?', 0, 0, 0,
+    0, 0, '"', 0, 0, '.', 0, 0, 0, 0, '@', 0, 0, 0, '\'', 0,
+    0, '-', 0, 0, 0, 0, 0, 0, 0, 0, ';', 0, 0, ')', 0, 0,
+    0, 0, 0, ',', 0, 0, 0, 0, ':', 0, 0, 0, 0, 0, 0, 0,
 };
 
-static size_t morse_table_size = sizeof(morse_table) / sizeof(morse_map_t);
+// Symbol pairs Morse turns up in. Alternatives are only tried when their dash symbol is present, and
+// since 0/1 and dots also make up binary and punctuation, they must decode every letter.
+typedef struct {
+    const char * label;
+    char dot;
+    char dash;
+} morse_symbols_t;
+
+static const morse_symbols_t MORSE_SYMBOLS[] = {
+    { "MORSE", '.', '-' },
+    { "MORSE (0/1)", '0', '1' },
+    { "MORSE (_/.)", '.', '_' },
+};
 
-static char morse_decode_char(const char * morse) {
-    for (size_t i = 0; i < morse_table_size; i++) {
-        if (strcmp(morse, morse_table[i].morse) == 0) {
-            return morse_table[i].alpha;
-        }
-    }
-    return '?';
+// Rotation alphabets share one kernel. Each ring is an inclusive byte range and every ring is
+// rotated by the same shift, so all rings of an alphabet must be the same size.
+typedef struct {
+    const char * label;
+    const char * rings;
+    int top; // shifts to emit for rankable text, 0 = all
+} rotation_t;
+
+static const rotation_t ROTATION_LETTERS = { "ROT", "azAZ", 3 };
+static const rotation_t ROTATION_PRINTABLE = { "ROT47", "!~", 3 };
+static const rotation_t ROTATION_DIGITS = { "ROT5", "09", 0 };
+
+static void result_push(solver_result_t * result, sds data, sds method, float fitness) {
+    result -> outputs = realloc(result -> outputs, sizeof(solver_output_t) * (result -> len + 1));
+    result -> outputs[result -> len].data = data;
+    result -> outputs[result -> len].method = method;
+    result -> outputs[result -> len].fitness = fitness;
+    result -> len++;
 }
 
 // hex string to bytes
@@ -108,6 +217,164 @@ solver_fn(BASE64) {
     return result;
 }
 
+// Decoded bytes become one output unless they are too short to be what the input encodes, frees decoded
+static void encoding_push(solver_result_t * result, unsigned char * decoded, size_t out_len, size_t in_len, const char * method) {
+    if (!decoded) return;
+    if (out_len == 0 || out_len < in_len * ENCODING_MIN_RATIO) {
+        free(decoded);
+        return;
+    }
+    sds data = sdsnewlen(decoded, out_len);
+    free(decoded);
+    result_push(result, data, sdsnew(method), score_combined(data, out_len, 0));
+}
+
+solver_fn(BASE32) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+    size_t in_len = sdslen(input);
+    size_t out_len = 0;
+    unsigned char * decoded = base32_decode(input, in_len, 0, & out_len);
+    encoding_push(& result, decoded, out_len, in_len, "BASE32");
+    decoded = base32_decode(input, in_len, 1, & out_len);
+    encoding_push(& result, decoded, out_len, in_len, "BASE32HEX");
+    return result;
+}
+
+solver_fn(BASE58) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+    size_t in_len = sdslen(input);
+    size_t out_len = 0;
+    unsigned char * decoded = base58_decode(input, in_len, 0, & out_len);
+    encoding_push(& result, decoded, out_len, in_len, "BASE58");
+    decoded = base58_decode(input, in_len, 1, & out_len);
+    encoding_push(& result, decoded, out_len, in_len, "BASE58 (flickr)");
+    return result;
+}
+
+solver_fn(BASE85) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+    size_t in_len = sdslen(input);
+    size_t out_len = 0;
+    unsigned char * decoded = ascii85_decode(input, in_len, & out_len);
+    encoding_push(& result, decoded, out_len, in_len, "ASCII85");
+    decoded = z85_decode(input, in_len, & out_len);
+    encoding_push(& result, decoded, out_len, in_len, "Z85");
+    return result;
+}
+
+solver_fn(BASE91) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+    size_t in_len = sdslen(input);
+    size_t out_len = 0;
+    unsigned char * decoded = base91_decode(input, in_len, & out_len);
+    encoding_push(& result, decoded, out_len, in_len, "BASE91");
+    return result;
+}
+
+// Deflate stream offset inside a gzip (RFC 1952) or zlib (RFC 1950) wrapper. NULL when neither header
+// is present; a bare deflate stream has no magic to check.
+static const char * compressed_format(const unsigned char * data, size_t len, size_t * offset) {
+    if (len >= 18 && data[0] == 0x1f && data[1] == 0x8b && data[2] == 8) {
+        int flags = data[3];
+        size_t pos = 10;
+        if (flags & 4) pos += 2 + (data[pos] | (data[pos + 1] << 8));
+        if (flags & 8) while (pos < len && data[pos++]);
+        if (flags & 16) while (pos < len && data[pos++]);
+        if (flags & 2) pos += 2;
+        if (pos >= len) return NULL;
+        * offset = pos;
+        return "GZIP";
+    }
+    if (len >= 6 && (data[0] & 0x0f) == 8 && (data[0] >> 4) <= 7 && ((data[0] << 8) | data[1]) % 31 == 0 && !(data[1] & 0x20)) {
+        * offset = 2;
+        return "ZLIB";
+    }
+    return NULL;
+}
+
+static size_t inflate_limit(size_t compressed_len) {
+    size_t limit = compressed_len * INFLATE_MAX_RATIO;
+    return limit < INFLATE_MAX_OUTPUT ? limit : INFLATE_MAX_OUTPUT;
+}
+
+static sds inflate_finish(sds pending) {
+    const unsigned char * data = (const unsigned char *) pending;
+    size_t len = sdslen(pending);
+    size_t offset = 0;
+    compressed_format(data, len, & offset);
+
+    size_t out_len;
+    int complete;
+    unsigned char * out = inflate_raw(data + offset, len - offset, inflate_limit(len), & out_len, & complete);
+    if (!out) return NULL;
+    sds full = sdsnewlen(out, out_len);
+    free(out);
+    return full;
+}
+
+solver_fn(INFLATE) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    const unsigned char * data = (const unsigned char *) input;
+    size_t len = sdslen(input);
+    size_t offset = 0;
+    const char * format = compressed_format(data, len, & offset);
+
+    // Without magic, only binary nodes are worth trying as bare deflate
+    if (!format) {
+        size_t i = 0;
+        while (i < len && (isprint(data[i]) || data[i] == '\n' || data[i] == '\r' || data[i] == '\t')) i++;
+        if (len < 2 || i == len) return result;
+        format = "DEFLATE";
+    }
+
+    size_t limit = inflate_limit(len);
+    size_t prefix_len = limit < INFLATE_PREFIX ? limit : INFLATE_PREFIX;
+    size_t out_len;
+    int complete;
+    unsigned char * out = inflate_raw(data + offset, len - offset, prefix_len, & out_len, & complete);
+    if (!out) return result;
+    if (out_len == 0) {
+        free(out);
+        return result;
+    }
+
+    sds prefix = sdsnewlen(out, out_len);
+    free(out);
+    float fitness = score_combined(prefix, out_len, 0);
+
+    // Random bytes often parse as a few deflate symbols, a bare stream has to inflate to text
+    if (offset == 0 && fitness < 1.0f) {
+        sdsfree(prefix);
+        return result;
+    }
+
+    result_push(&result, prefix, sdsnew(format), fitness);
+    solver_output_t * output = & result.outputs[result.len - 1];
+    output -> pending = NULL;
+    output -> finish = NULL;
+    if (!complete && prefix_len < limit) {
+        output -> pending = sdsdup(input);
+        output -> finish = inflate_finish;
+    }
+    return result;
+}
+
 solver_fn(BINARY) {
     int in_len = sdslen(input);
     int out_len;
@@ -200,6 +467,16 @@ char * affine_decrypt(sds text, int a, int b) {
     return out;
 }
 
+// Byte map of affine_decrypt, for scoring a key from the input's statistics
+static void affine_build_map(int a_inv, int b, unsigned char map[256]) {
+    for (int c = 0; c < 256; c++) map[c] = (unsigned char) c;
+    for (int i = 0; i < ALPHABET_SIZE; i++) {
+        int p = (a_inv * (i - b + ALPHABET_SIZE)) % ALPHABET_SIZE;
+        map['A' + i] = (unsigned char)('A' + p);
+        map['a' + i] = (unsigned char)('a' + p);
+    }
+}
+
 solver_fn(AFFINE) {
     solver_result_t result = {
         .len = 0,
@@ -208,7 +485,11 @@ solver_fn(AFFINE) {
 
     int candidates = 0;
 
-    for (int a = 1; a < ALPHABET_SIZE; a++) {
+    // a=1 is a plain shift, ROT ranks those from a single histogram
+    for (int a = 3; a < ALPHABET_SIZE; a++) {
+        int a_inv = mod_inverse(a, ALPHABET_SIZE);
+        if (a_inv == -1) continue;
+
         for (int b = 0; b < ALPHABET_SIZE; b++) {
             sds plain = affine_decrypt(input, a, b);
             if (!plain) continue;
@@ -216,8 +497,13 @@ solver_fn(AFFINE) {
             sds decrypted = sdsnew(plain);
             free(plain);
 
+            unsigned char map[256];
+            affine_build_map(a_inv, b, map);
+            text_stats_t derived;
+            text_stats_derive(stats, &(text_transform_t) { .kind = TRANSFORM_BYTE_MAP, .map = map }, &derived);
+
             float penalty = ((float) a * ALPHABET_SIZE + (float) b) / (ALPHABET_SIZE * ALPHABET_SIZE);
-            float fitness = score_combined(decrypted, sdslen(decrypted), 1) - (penalty * PENALTY_FACTOR);
+            float fitness = score_combined_stats(&derived, 1) - (penalty * PENALTY_FACTOR);
 
             result.outputs = realloc(result.outputs, sizeof(solver_output_t) * (candidates + 1));
             result.outputs[candidates].data = decrypted;
@@ -231,317 +517,2198 @@ solver_fn(AFFINE) {
     return result;
 }
 
-static solver_result_t solve_VIGENERE(sds input, keychain_t * keychain) {
+// Decryption map for an alphabet rotated forward by `shift` during encryption
+static void rotation_build_map(const rotation_t * rot, int shift, unsigned char map[256]) {
+    for (int c = 0; c < 256; c++) map[c] = (unsigned char) c;
+
+    for (const char * r = rot -> rings; r[0] && r[1]; r += 2) {
+        int first = (unsigned char) r[0];
+        int size = (unsigned char) r[1] - first + 1;
+        for (int i = 0; i < size; i++) {
+            map[first + i] = (unsigned char)(first + (i - shift % size + size) % size);
+        }
+    }
+}
+
+static solver_result_t rotation_solve(sds input, const text_stats_t * stats, const rotation_t * rot) {
     solver_result_t result = {
         .len = 0,
         .outputs = NULL,
     };
 
-    if (keychain == NULL || keychain -> len == 0) return result;
-
-    int candidates = 0;
-    int input_len = sdslen(input);
+    size_t len = sdslen(input);
+    if (len == 0) return result;
 
-    // Vigenere requires alpha only? Or we skip non-alpha.
-    // Standard implementation: skip non-alpha in plaintext, rotate by key.
-    // Decryption: P = (C - K + 26) % 26
+    int size = (unsigned char) rot -> rings[1] - (unsigned char) rot -> rings[0] + 1;
 
-    for (int k = 0; k < keychain -> len; k++) {
-        sds key = keychain -> keys[k];
-        int key_len = sdslen(key);
-        if (key_len == 0) continue;
+    const int * counts = stats -> counts;
 
-        sds output = sdsdup(input);
-        int key_idx = 0;
+    int rotated = 0;
+    for (const char * r = rot -> rings; r[0] && r[1]; r += 2) {
+        for (int c = (unsigned char) r[0]; c <= (unsigned char) r[1]; c++) rotated += counts[c];
+    }
+    if (rotated == 0) return result;
+
+    // Rank every shift from the one histogram, no candidate text is built here
+    int shifts[256];
+    float scores[256];
+    int n = 0;
+    for (int s = 1; s < size; s++) {
+        unsigned char map[256];
+        rotation_build_map(rot, s, map);
+
+        int shifted[256] = {0};
+        for (int c = 0; c < 256; c++) shifted[map[c]] += counts[c];
+
+        float score = score_byte_histogram(shifted, len);
+
+        // Insertion sort, at most 93 shifts
+        int j = n++;
+        while (j > 0 && scores[j - 1] < score) {
+            scores[j] = scores[j - 1];
+            shifts[j] = shifts[j - 1];
+            j--;
+        }
+        scores[j] = score;
+        shifts[j] = s;
+    }
 
-        for (int i = 0; i < input_len; i++) {
-            if (isalpha(output[i])) {
-                char base = isupper(output[i]) ? 'A' : 'a';
+    int emit = n;
+    if (rot -> top > 0 && rotated >= ROTATION_MIN_LETTERS && rot -> top < n) emit = rot -> top;
 
-                char k_char = key[key_idx % key_len];
-                int shift = 0;
-                if (isupper(k_char)) shift = k_char - 'A';
-                else if (islower(k_char)) shift = k_char - 'a';
+    for (int r = 0; r < emit; r++) {
+        unsigned char map[256];
+        rotation_build_map(rot, shifts[r], map);
 
-                // Decrypt: (C - base - shift + 26) % 26 + base
-                int c_val = output[i] - base;
-                int p_val = (c_val - shift + 26) % 26;
-                output[i] = p_val + base;
+        sds plain = sdsnewlen(NULL, len);
+        for (size_t i = 0; i < len; i++) plain[i] = map[(unsigned char) input[i]];
 
-                key_idx++;
-            }
-        }
+        text_stats_t derived;
+        text_stats_derive(stats, &(text_transform_t) { .kind = TRANSFORM_BYTE_MAP, .map = map }, &derived);
 
-        float penalty = ((float) k) / keychain -> len;
-        float fitness = score_combined(output, sdslen(output), 1) - (penalty * PENALTY_FACTOR);
+        float penalty = (float) r / n;
+        float fitness = score_combined_stats(&derived, 1) - (penalty * PENALTY_FACTOR);
 
-        result.outputs = realloc(result.outputs, sizeof(solver_output_t) * (candidates + 1));
-        result.outputs[candidates].data = output;
-        result.outputs[candidates].method = sdscatprintf(sdsempty(), "VIGENERE(%s)", key);
-        result.outputs[candidates].fitness = fitness * SIMPLE_CIPHER_FITNESS_FACTOR;
-        candidates++;
+        result_push(&result, plain, sdscatprintf(sdsempty(), "%s n=%d", rot -> label, shifts[r]),
+            fitness * SIMPLE_CIPHER_FITNESS_FACTOR);
     }
 
-    result.len = candidates;
     return result;
 }
 
-solver_fn(RAILFENCE) {
-    solver_result_t result = {
-        .len = 0,
-        .outputs = NULL,
-    };
+solver_fn(ROT) {
+    return rotation_solve(input, stats, &ROTATION_LETTERS);
+}
 
-    int candidates = 0;
-    int len = sdslen(input);
-    if (len < 2) return result;
+solver_fn(ROT47) {
+    return rotation_solve(input, stats, &ROTATION_PRINTABLE);
+}
 
-    int max_rails = len > 32 ? 32 : (len < 4 ? len : len/2 + 2);
+solver_fn(ROT5) {
+    // Pure numerals (binary, octal, decimal) belong to their own decoders, rotating them only breeds false numerals
+    size_t len = sdslen(input);
+    size_t i = 0;
+    while (i < len && !isalpha((unsigned char) input[i])) i++;
+    if (i == len) return (solver_result_t) { .len = 0, .outputs = NULL };
 
-    for (int k = 2; k < max_rails; k++) {
-        int cycle_len = 2 * k - 2;
-        for (int o = 0; o < cycle_len; o++) {
-            // Rail Fence Decryption with Offset
-            // 1. Mark spots
-            char *matrix = calloc(k * len, sizeof(char));
-            if (!matrix) continue;
+    return rotation_solve(input, stats, &ROTATION_DIGITS);
+}
 
-            for (int i = 0; i < len; i++) {
-                int cycle_pos = (i + o) % cycle_len;
-                int row = cycle_pos < k ? cycle_pos : cycle_len - cycle_pos;
-                matrix[row * len + i] = '*'; // marker
-            }
+// Fixed substitutions described as data. BYTEMAP_BYTES maps from[i] -> to[i] and leaves every other
+// byte alone; BYTEMAP_TOKENS reads decimal tokens and maps value first + i -> to[i], with '-', ',' and
+// '.' joining letters and spaces or '/' separating words. Either way one 256-entry table does the work,
+// so a new mapping is one more BYTEMAPS row.
+typedef enum {
+    BYTEMAP_BYTES,
+    BYTEMAP_TOKENS,
+} bytemap_kind_t;
 
-            // 2. Fill spots with ciphertext
-            int idx = 0;
-            for (int r = 0; r < k; r++) {
-                for (int c = 0; c < len; c++) {
-                    if (matrix[r * len + c] == '*' && idx < len) {
-                        matrix[r * len + c] = input[idx++];
-                    }
-                }
-            }
+typedef struct {
+    const char * label;
+    bytemap_kind_t kind;
+    const char * from;
+    const char * to;
+    int first;
+} bytemap_t;
+
+static const bytemap_t BYTEMAPS[] = {
+    { "ATBASH", BYTEMAP_BYTES,
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ",
+        "zyxwvutsrqponmlkjihgfedcbaZYXWVUTSRQPONMLKJIHGFEDCBA" },
+    { "ATBASH47", BYTEMAP_BYTES,
+        "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~",
+        "~}|{zyxwvutsrqponmlkjihgfedcba`_^]\\[ZYXWVUTSRQPONMLKJIHGFEDCBA@?>=<;:9876543210/.-,+*)('&%$#\"!" },
+    { "CASE_SWAP", BYTEMAP_BYTES,
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz" },
+    // Typed one key to the right on a QWERTY keyboard
+    { "QWERTY_LEFT", BYTEMAP_BYTES,
+        "1234567890-=wertyuiop[]\\sdfghjkl;'xcvbnm,./!@#$%^&*()_+WERTYUIOP{}|SDFGHJKL:\"XCVBNM<>?",
+        "`1234567890-qwertyuiop[]asdfghjkl;zxcvbnm,.~!@#$%^&*()_QWERTYUIOP{}ASDFGHJKL:ZXCVBNM<>" },
+    // Typed one key to the left
+    { "QWERTY_RIGHT", BYTEMAP_BYTES,
+        "`1234567890-qwertyuiop[]asdfghjkl;zxcvbnm,.~!@#$%^&*()_QWERTYUIOP{}ASDFGHJKL:ZXCVBNM<>",
+        "1234567890-=wertyuiop[]\\sdfghjkl;'xcvbnm,./!@#$%^&*()_+WERTYUIOP{}|SDFGHJKL:\"XCVBNM<>?" },
+    { "A1Z26", BYTEMAP_TOKENS, NULL, "ABCDEFGHIJKLMNOPQRSTUVWXYZ", 1 },
+};
 
-            // 3. Read zigzag
-            sds plain = sdsnewlen(NULL, len);
-            for (int i = 0; i < len; i++) {
-                int cycle_pos = (i + o) % cycle_len;
-                int row = cycle_pos < k ? cycle_pos : cycle_len - cycle_pos;
-                plain[i] = matrix[row * len + i];
-            }
+#define BYTEMAP_COUNT (sizeof(BYTEMAPS) / sizeof(BYTEMAPS[0]))
 
-            free(matrix);
+static unsigned char bytemap_tables[BYTEMAP_COUNT][256];
+static int bytemap_tables_built = 0;
 
-            float penalty =  ((float) k + (float) o) / (max_rails + cycle_len);
-            float fitness = score_combined(plain, sdslen(plain), 1) - (penalty * PENALTY_FACTOR);
+static void bytemap_build_tables(void) {
+    for (size_t m = 0; m < BYTEMAP_COUNT; m++) {
+        const bytemap_t * map = & BYTEMAPS[m];
+        unsigned char * table = bytemap_tables[m];
+        for (int c = 0; c < 256; c++) table[c] = map -> kind == BYTEMAP_BYTES ? c : 0;
+        for (size_t i = 0; map -> to[i]; i++) {
+            int src = map -> kind == BYTEMAP_BYTES ? (unsigned char) map -> from[i] : map -> first + (int) i;
+            table[src] = (unsigned char) map -> to[i];
+        }
+    }
+    bytemap_tables_built = 1;
+}
 
-            result.outputs = realloc(result.outputs, sizeof(solver_output_t) * (candidates + 1));
-            result.outputs[candidates].data = plain;
-            result.outputs[candidates].method = sdscatprintf(sdsempty(), "RAILFENCE k=%d o=%d", k, o);
-            result.outputs[candidates].fitness = fitness * SIMPLE_CIPHER_FITNESS_FACTOR;
-            candidates++;
+// NULL when the mapping leaves the input unchanged
+static sds bytemap_apply_bytes(const char * input, size_t len, const unsigned char * table) {
+    sds out = sdsnewlen(NULL, len);
+    unsigned char changed = 0;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        unsigned char a = input[i], b = input[i + 1], c = input[i + 2], d = input[i + 3];
+        out[i] = table[a];
+        out[i + 1] = table[b];
+        out[i + 2] = table[c];
+        out[i + 3] = table[d];
+        changed |= (out[i] ^ a) | (out[i + 1] ^ b) | (out[i + 2] ^ c) | (out[i + 3] ^ d);
+    }
+    for (; i < len; i++) {
+        out[i] = table[(unsigned char) input[i]];
+        changed |= out[i] ^ input[i];
+    }
+    if (!changed) {
+        sdsfree(out);
+        return NULL;
+    }
+    return out;
+}
+
+// NULL on the first byte or token the mapping does not cover
+static sds bytemap_apply_tokens(const char * input, size_t len, const unsigned char * table) {
+    sds out = sdsnewlen(NULL, len);
+    size_t j = 0;
+    int value = -1;
+    for (size_t i = 0; i <= len; i++) {
+        char c = i < len ? input[i] : ' ';
+        if (isdigit((unsigned char) c)) {
+            value = (value < 0 ? 0 : value * 10) + (c - '0');
+            if (value > 255) break;
+            continue;
+        }
+
+        int word_end = c == ' ' || c == '/';
+        if (!word_end && c != '-' && c != ',' && c != '.') break;
+        if (value >= 0) {
+            if (!table[value]) break;
+            out[j++] = table[value];
+            value = -1;
+        }
+        if (word_end && j > 0 && out[j - 1] != ' ') out[j++] = ' ';
+
+        if (i == len) {
+            if (j > 0 && out[j - 1] == ' ') j--;
+            if (j == 0) break;
+            sdssetlen(out, j);
+            out[j] = '\0';
+            return out;
         }
     }
+    sdsfree(out);
+    return NULL;
+}
+
+solver_fn(BYTEMAP) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    size_t len = sdslen(input);
+    if (len == 0) return result;
+    if (!bytemap_tables_built) bytemap_build_tables();
+
+    for (size_t m = 0; m < BYTEMAP_COUNT; m++) {
+        const bytemap_t * map = & BYTEMAPS[m];
+        sds plain = map -> kind == BYTEMAP_BYTES
+            ? bytemap_apply_bytes(input, len, bytemap_tables[m])
+            : bytemap_apply_tokens(input, len, bytemap_tables[m]);
+        if (!plain) continue;
+
+        float fitness = score_combined(plain, sdslen(plain), 1);
+        result_push(&result, plain, sdsnew(map -> label), fitness * SIMPLE_CIPHER_FITNESS_FACTOR);
+    }
 
-    result.len = candidates;
     return result;
 }
 
-solver_fn(BASE) {
+// Bit- and byte-level reshaping. Each one undoes itself, so they are registered with prevent_consecutive
+// and handles_non_printable: they mostly turn up between binary intermediates.
+static unsigned char nibble_swap_table[256];
+static unsigned char bit_reverse_table[256];
+static int reshape_tables_built = 0;
+
+static void reshape_build_tables(void) {
+    for (int c = 0; c < 256; c++) {
+        nibble_swap_table[c] = (unsigned char) ((c << 4) | (c >> 4));
+        unsigned char r = 0;
+        for (int b = 0; b < 8; b++) r |= ((c >> b) & 1) << (7 - b);
+        bit_reverse_table[c] = r;
+    }
+    reshape_tables_built = 1;
+}
+
+// Nibble and bit shuffles of text are binary noise, so those only run on binary input
+static int reshape_is_binary(const text_stats_t * stats) {
+    return stats -> non_printable > 0;
+}
+
+// The transform only moves or relabels the input's bytes, so the output is scored from derived statistics
+static solver_result_t reshape_result(sds output, const char * method, int force_shannon,
+    const text_stats_t * stats, text_transform_t transform) {
     solver_result_t result = {
         .len = 0,
         .outputs = NULL,
     };
+    if (!output) return result;
+    text_stats_t derived;
+    text_stats_derive(stats, &transform, &derived);
+    float fitness = score_combined_stats(&derived, force_shannon);
+    result_push(&result, output, sdsnew(method), force_shannon ? fitness * SIMPLE_CIPHER_FITNESS_FACTOR : fitness);
+    return result;
+}
 
-    int candidates = 0;
-    int len = sdslen(input);
-    if (len == 0) return result;
+#define RESHAPE_TRANSPOSE ((text_transform_t) { .kind = TRANSFORM_TRANSPOSE })
+#define RESHAPE_BYTE_MAP(table) ((text_transform_t) { .kind = TRANSFORM_BYTE_MAP, .map = (table) })
 
-    // Try bases 2 through 36
-    for (int base = 2; base <= 36; base++) {
-        // Validate if input is valid for this base
-        int is_valid = 1;
-        for (int i = 0; i < len; i++) {
-            int val = -1;
-            char c = input[i];
-            
-            if (isdigit(c)) val = c - '0';
-            else if (islower(c)) val = c - 'a' + 10;
-            else if (isupper(c)) val = c - 'A' + 10;
-
-            if (val == -1 || val >= base) {
-                is_valid = 0;
-                break;
-            }
-        }
+solver_fn(REVERSE) {
+    size_t len = sdslen(input);
+    if (len < 2) return reshape_result(NULL, NULL, 0, stats, RESHAPE_TRANSPOSE);
 
-        if (!is_valid) continue;
+    sds out = sdsnewlen(NULL, len);
+    for (size_t i = 0; i < len; i++) out[i] = input[len - 1 - i];
+    // Same characters in the same amounts, only entropy can tell the orders apart
+    return reshape_result(out, "REVERSE", 1, stats, RESHAPE_TRANSPOSE);
+}
 
-        // Perform base conversion to decimal using unsigned long long
-        unsigned long long acc = 0;
-        int overflow = 0;
+solver_fn(NIBBLE_SWAP) {
+    if (!reshape_is_binary(stats)) return reshape_result(NULL, NULL, 0, stats, RESHAPE_TRANSPOSE);
+    if (!reshape_tables_built) reshape_build_tables();
+    return reshape_result(bytemap_apply_bytes(input, sdslen(input), nibble_swap_table), "NIBBLE_SWAP", 0,
+        stats, RESHAPE_BYTE_MAP(nibble_swap_table));
+}
 
-        for (int i = 0; i < len; i++) {
-            char c = input[i];
-            int val = 0;
-            if (isdigit(c)) val = c - '0';
-            else if (islower(c)) val = c - 'a' + 10;
-            else if (isupper(c)) val = c - 'A' + 10;
-
-            // Check overflow: acc * base + val > ULLONG_MAX
-            if (acc > (0xFFFFFFFFFFFFFFFFULL - val) / base) {
-                overflow = 1;
-                break;
-            }
+solver_fn(BIT_REVERSE) {
+    if (!reshape_is_binary(stats)) return reshape_result(NULL, NULL, 0, stats, RESHAPE_TRANSPOSE);
+    if (!reshape_tables_built) reshape_build_tables();
+    return reshape_result(bytemap_apply_bytes(input, sdslen(input), bit_reverse_table), "BIT_REVERSE", 0,
+        stats, RESHAPE_BYTE_MAP(bit_reverse_table));
+}
 
-            acc = acc * base + val;
+// Swaps byte order within each word; only whole words qualify. Like REVERSE it only reorders bytes.
+static sds endian_swap(const char * input, size_t len, size_t width) {
+    if (len < 2 * width || len % width != 0) return NULL;
+
+    sds out = sdsnewlen(NULL, len);
+    if (width == 2) {
+        for (size_t i = 0; i < len; i += 2) {
+            uint16_t w;
+            memcpy(&w, input + i, 2);
+            w = __builtin_bswap16(w);
+            memcpy(out + i, &w, 2);
+        }
+    } else {
+        for (size_t i = 0; i < len; i += 4) {
+            uint32_t w;
+            memcpy(&w, input + i, 4);
+            w = __builtin_bswap32(w);
+            memcpy(out + i, &w, 4);
         }
+    }
+    if (memcmp(out, input, len) == 0) {
+        sdsfree(out);
+        return NULL;
+    }
+    return out;
+}
 
-        if (overflow) {
-            continue;
+solver_fn(ENDIAN16) {
+    return reshape_result(endian_swap(input, sdslen(input), 2), "ENDIAN16", 1, stats, RESHAPE_TRANSPOSE);
+}
+
+solver_fn(ENDIAN32) {
+    return reshape_result(endian_swap(input, sdslen(input), 4), "ENDIAN32", 1, stats, RESHAPE_TRANSPOSE);
+}
+
+// Vigenere requires alpha only? Or we skip non-alpha.
+// Standard implementation: skip non-alpha in plaintext, rotate by key.
+// Decryption: P = (C - K + 26) % 26
+static sds vigenere_decrypt(sds input, const char * key, int key_len) {
+    int input_len = sdslen(input);
+    sds output = sdsdup(input);
+    int key_idx = 0;
+
+    for (int i = 0; i < input_len; i++) {
+        if (isalpha(output[i])) {
+            char base = isupper(output[i]) ? 'A' : 'a';
+
+            char k_char = key[key_idx % key_len];
+            int shift = 0;
+            if (isupper(k_char)) shift = k_char - 'A';
+            else if (islower(k_char)) shift = k_char - 'a';
+
+            // Decrypt: (C - base - shift + 26) % 26 + base
+            int c_val = output[i] - base;
+            int p_val = (c_val - shift + 26) % 26;
+            output[i] = p_val + base;
+
+            key_idx++;
         }
+    }
+
+    return output;
+}
 
-        sds decimal_str = sdsfromlonglong(acc);
+// Streaming key scan for wordlist-driven solvers. Each key is scored from the histogram of the bytes it
+// would produce, no output is built, and only the KEYED_TOP_K best survive. Large wordlists are split into
+// disjoint key ranges with one bounded top list per range, merged at the end.
+typedef float (*keyed_score_fn)(sds input, const char * key, int key_len);
 
-        float penalty = ((float) base) / 36.0f;
-        float fitness = score_combined(decimal_str, sdslen(decimal_str), 0) - (penalty * PENALTY_FACTOR);
+typedef struct {
+    int keys[KEYED_TOP_K];
+    float scores[KEYED_TOP_K];
+    int count;
+} keyed_top_t;
+
+typedef struct {
+    sds input;
+    const keychain_t * keychain;
+    keyed_score_fn score;
+    int chunk;
+    keyed_top_t * tops;
+} keyed_scan_t;
+
+// Ties keep the earlier key, so the wordlist order still breaks them
+static void keyed_top_insert(keyed_top_t * top, int key, float score) {
+    if (top -> count == KEYED_TOP_K && score <= top -> scores[KEYED_TOP_K - 1]) return;
+
+    int j = top -> count < KEYED_TOP_K ? top -> count++ : KEYED_TOP_K - 1;
+    while (j > 0 && (top -> scores[j - 1] < score || (top -> scores[j - 1] == score && top -> keys[j - 1] > key))) {
+        top -> scores[j] = top -> scores[j - 1];
+        top -> keys[j] = top -> keys[j - 1];
+        j--;
+    }
+    top -> scores[j] = score;
+    top -> keys[j] = key;
+}
 
-        result.outputs = realloc(result.outputs, sizeof(solver_output_t) * (candidates + 1));
-        result.outputs[candidates].data = decimal_str;
-        result.outputs[candidates].method = sdscatprintf(sdsempty(), "BASE (base %d)", base);
-        result.outputs[candidates].fitness = fitness;
-        candidates++;
+static void keyed_scan_task(int task, void * ctx) {
+    keyed_scan_t * scan = ctx;
+    keyed_top_t * top = & scan -> tops[task];
+    top -> count = 0;
+
+    int end = (task + 1) * scan -> chunk;
+    if (end > scan -> keychain -> len) end = scan -> keychain -> len;
+    for (int k = task * scan -> chunk; k < end; k++) {
+        const key_view_t * key = & scan -> keychain -> keys[k];
+        if (key -> len == 0) continue;
+        keyed_top_insert(top, k, scan -> score(scan -> input, key -> data, (int) key -> len));
     }
+}
 
-    result.len = candidates;
-    return result;
+// Indices of the best keys, best first. Returns how many were written.
+static int keyed_scan(sds input, const keychain_t * keychain, keyed_score_fn score, int best[KEYED_TOP_K]) {
+    if (keychain == NULL || keychain -> len == 0) return 0;
+
+    int tasks = 1;
+    if ((long long) keychain -> len * sdslen(input) >= KEYED_PARALLEL_MIN) tasks = cpu_count() * 4;
+    if (tasks > keychain -> len) tasks = keychain -> len;
+
+    keyed_top_t * tops = malloc(sizeof(keyed_top_t) * tasks);
+    if (!tops) return 0;
+    keyed_scan_t scan = {
+        .input = input,
+        .keychain = keychain,
+        .score = score,
+        .chunk = (keychain -> len + tasks - 1) / tasks,
+        .tops = tops,
+    };
+    if (tasks > 1) parallel_for(tasks, keyed_scan_task, & scan);
+    else keyed_scan_task(0, & scan);
+
+    keyed_top_t merged = { .count = 0 };
+    for (int t = 0; t < tasks; t++) {
+        for (int r = 0; r < tops[t].count; r++) keyed_top_insert(& merged, tops[t].keys[r], tops[t].scores[r]);
+    }
+    free(tops);
+
+    memcpy(best, merged.keys, sizeof(int) * merged.count);
+    return merged.count;
 }
 
-solver_fn(MORSE) {
+// English likeness of vigenere_decrypt(input, key) from its histogram alone
+static float vigenere_key_score(sds input, const char * key, int key_len) {
+    int counts[256] = {0};
+    int input_len = sdslen(input);
+    int key_idx = 0;
+    for (int i = 0; i < input_len; i++) {
+        unsigned char c = (unsigned char) input[i];
+        if (isalpha(c)) {
+            char base = isupper(c) ? 'A' : 'a';
+            char k_char = key[key_idx % key_len];
+            int shift = isupper((unsigned char) k_char) ? k_char - 'A' : islower((unsigned char) k_char) ? k_char - 'a' : 0;
+            c = (unsigned char) ((c - base - shift + 26) % 26 + base);
+            key_idx++;
+        }
+        counts[c]++;
+    }
+    return score_byte_histogram(counts, input_len);
+}
+
+static solver_result_t solve_VIGENERE(sds input, keychain_t * keychain, const text_stats_t * stats) {
     solver_result_t result = {
         .len = 0,
         .outputs = NULL,
     };
 
-    // Word delimiters: /, \, \n, \r, ,, ;, :
-    const char * word_delims = "/\\\n\r,;:";
-    
-    sds work_copy = sdsdup(input);
-    for (size_t i = 0; i < sdslen(work_copy); i++) {
-        if (strchr(word_delims, work_copy[i])) {
-            work_copy[i] = '|'; // Use a canonical word separator
-        }
-    }
+    int best[KEYED_TOP_K];
+    int survivors = keyed_scan(input, keychain, vigenere_key_score, best);
 
-    int word_count = 0;
-    sds * words = sdssplitlen(work_copy, sdslen(work_copy), "|", 1, & word_count);
-    sdsfree(work_copy);
+    for (int r = 0; r < survivors; r++) {
+        const char * key = keychain -> keys[best[r]].data;
+        int key_len = (int) keychain -> keys[best[r]].len;
 
-    if (word_count == 0) {
-        sdsfreesplitres(words, word_count);
-        return result;
+        sds output = vigenere_decrypt(input, key, key_len);
+
+        float penalty = ((float) r) / survivors;
+        float fitness = score_combined(output, sdslen(output), 1) - (penalty * PENALTY_FACTOR);
+
+        result_push(&result, output, sdscatprintf(sdsempty(), "VIGENERE(%.*s)", key_len, key),
+            fitness * SIMPLE_CIPHER_FITNESS_FACTOR);
     }
 
-    sds plain = sdsempty();
-    int total_chars = 0;
-    int valid_chars = 0;
-
-    for (int i = 0; i < word_count; i++) {
-        int letter_count = 0;
-        sds * letters = sdssplitlen(words[i], sdslen(words[i]), " ", 1, & letter_count);
-        
-        for (int j = 0; j < letter_count; j++) {
-            sdstrim(letters[j], " \t\r\n");
-            if (sdslen(letters[j]) == 0) continue;
-            
-            char decoded = morse_decode_char(letters[j]);
-            if (decoded != '?') {
-                plain = sdscatlen(plain, & decoded, 1);
-                valid_chars++;
-            }
-            total_chars++;
-        }
-        sdsfreesplitres(letters, letter_count);
-        
-        if (i < word_count - 1 && sdslen(plain) > 0 && plain[sdslen(plain)-1] != ' ') {
-            plain = sdscat(plain, " ");
+    return result;
+}
+
+// Average index of coincidence of the columns a period splits the letters into
+static float vigenere_period_ioc(const unsigned char * letters, int n, int period) {
+    float sum = 0.0f;
+    for (int col = 0; col < period; col++) {
+        int counts[26] = {0};
+        int total = 0;
+        for (int i = col; i < n; i += period) {
+            counts[letters[i]]++;
+            total++;
         }
+        sum += index_of_coincidence(counts, total);
     }
-    sdsfreesplitres(words, word_count);
+    return sum / period;
+}
 
-    if (total_chars == 0) {
-        sdsfree(plain);
-        return result;
-    }
+// Moves value to the front of a ranked list of at most cap entries, dropping the last one if it was not listed
+static void promote_first(int * list, int * count, int cap, int value) {
+    int j = 0;
+    while (j < *count && list[j] != value) j++;
+    if (j == *count && *count < cap) (*count)++;
+    if (j == cap) j--;
+    for (; j > 0; j--) list[j] = list[j - 1];
+    list[0] = value;
+}
 
-    float prob = (float) valid_chars / (float) total_chars;
-    if (prob < 0.5f) {
-        sdsfree(plain);
-        return result;
+// Solve every column of a period as a Caesar shift
+static void vigenere_solve_period(const unsigned char * letters, int n, int period, char * key) {
+    for (int col = 0; col < period; col++) {
+        int col_counts[26] = {0};
+        int total = 0;
+        for (int i = col; i < n; i += period) {
+            col_counts[letters[i]]++;
+            total++;
+        }
+        int shift = best_caesar_shift(col_counts, total, NULL);
+        key[col] = 'A' + shift;
     }
+    key[period] = '\0';
+}
 
-    result.outputs = malloc(sizeof(solver_output_t));
-    result.outputs[0].data = plain;
-    result.outputs[0].method = sdsnew("MORSE");
-    result.outputs[0].fitness = prob;
-    result.len = 1;
-
-    return result;
+// A key that repeats a shorter key decrypts identically, report it in its shortest form
+static int vigenere_reduce_key(const char * key, int key_len) {
+    for (int p = 1; p < key_len; p++) {
+        if (key_len % p != 0) continue;
+        int i = p;
+        while (i < key_len && key[i] == key[i - p]) i++;
+        if (i == key_len) return p;
+    }
+    return key_len;
 }
 
-static solver_result_t solve_XOR(sds input, keychain_t * keychain) {
+solver_fn(VIGENERE_CRACK) {
     solver_result_t result = {
         .len = 0,
         .outputs = NULL,
     };
 
-    if (keychain == NULL || keychain -> len == 0) return result;
-
-    int candidates = 0;
     int input_len = sdslen(input);
+    unsigned char * letters = malloc(input_len > 0 ? input_len : 1);
+    if (!letters) return result;
+
+    int n = 0;
+    int counts[26] = {0};
+    for (int i = 0; i < input_len; i++) {
+        if (isalpha((unsigned char) input[i])) {
+            letters[n] = tolower((unsigned char) input[i]) - 'a';
+            counts[letters[n]]++;
+            n++;
+        }
+    }
 
-    for (int k = 0; k < keychain -> len; k++) {
-        sds key = keychain -> keys[k];
-        int key_len = sdslen(key);
-        if (key_len == 0) continue;
+    // Plain, transposed and monoalphabetic text keep English's IoC, a polyalphabetic key flattens it
+    if (n < VIGENERE_MIN_LETTERS || index_of_coincidence(counts, n) > VIGENERE_MAX_IOC) {
+        free(letters);
+        return result;
+    }
 
-        sds output = sdsnewlen(NULL, input_len);
-        
-        for (int i = 0; i < input_len; i++) {
-            output[i] = input[i] ^ key[i % key_len];
+    int max_period = n / VIGENERE_MIN_COLUMN;
+    if (max_period > VIGENERE_MAX_PERIOD) max_period = VIGENERE_MAX_PERIOD;
+
+    int votes[VIGENERE_MAX_PERIOD + 1] = {0};
+    int max_votes = 0;
+    kasiski_votes(letters, n, max_period, votes);
+    for (int p = 2; p <= max_period; p++) {
+        if (votes[p] > max_votes) max_votes = votes[p];
+    }
+
+    // Multiples of the true period score as well as the period itself, so every period whose columns
+    // already read like English ranks shortest first. Otherwise rank by column IoC nudged by Kasiski.
+    int periods[VIGENERE_MAX_PERIOD + 1];
+    float period_scores[VIGENERE_MAX_PERIOD + 1];
+    int period_count = 0;
+    for (int p = 2; p <= max_period; p++) {
+        float ioc = vigenere_period_ioc(letters, n, p);
+        float score = ioc;
+        if (max_votes > 0) score += VIGENERE_KASISKI_WEIGHT * votes[p] / max_votes;
+        if (ioc >= VIGENERE_ENGLISH_IOC) score = 1.0f - (float) p / VIGENERE_MAX_PERIOD;
+
+        int j = period_count++;
+        while (j > 0 && period_scores[j - 1] < score) {
+            period_scores[j] = period_scores[j - 1];
+            periods[j] = periods[j - 1];
+            j--;
+        }
+        period_scores[j] = score;
+        periods[j] = p;
+    }
+    if (period_count > VIGENERE_TOP_PERIODS) period_count = VIGENERE_TOP_PERIODS;
+
+    // The autocorrelation period (the VIGENERE_PERIOD analyzer) is tried first when it stands out
+    float lift;
+    int hinted = coincidence_period(letters, n, max_period, &lift);
+    if (hinted > 0) promote_first(periods, &period_count, VIGENERE_TOP_PERIODS, hinted);
+
+    char keys[VIGENERE_TOP_PERIODS][VIGENERE_MAX_PERIOD + 1];
+    int key_count = 0;
+    for (int r = 0; r < period_count; r++) {
+        char * key = keys[key_count];
+        vigenere_solve_period(letters, n, periods[r], key);
+        key[vigenere_reduce_key(key, periods[r])] = '\0';
+
+        int duplicate = 0;
+        for (int k = 0; k < key_count; k++) {
+            if (strcmp(keys[k], key) == 0) duplicate = 1;
         }
+        if (!duplicate && strlen(key) > 1) key_count++;
+    }
+    free(letters);
 
-        float penalty = ((float) k) / keychain -> len;
-        float fitness = score_combined(output, input_len, 0) - (penalty * PENALTY_FACTOR);
+    for (int k = 0; k < key_count; k++) {
+        sds output = vigenere_decrypt(input, keys[k], strlen(keys[k]));
+
+        float penalty = ((float) k) / key_count;
+        float fitness = score_combined(output, sdslen(output), 1) - (penalty * PENALTY_FACTOR);
 
-        result.outputs = realloc(result.outputs, sizeof(solver_output_t) * (candidates + 1));
-        result.outputs[candidates].data = output;
-        result.outputs[candidates].method = sdscatprintf(sdsempty(), "XOR(%s)", key);
-        result.outputs[candidates].fitness = fitness;
-        candidates++;
+        result_push(&result, output, sdscatprintf(sdsempty(), "VIGENERE(%s)", keys[k]),
+            fitness * SIMPLE_CIPHER_FITNESS_FACTOR);
     }
 
-    result.len = candidates;
     return result;
 }
 
-solver_t solvers[] = {
-    SOLVER(HEX, 1, 0, 0),
-    SOLVER(BASE64, 1, 0, 0),
-    SOLVER(BINARY, 0.75, 0, 0),
-    SOLVER(OCTAL, 0.75, 0, 0),
-    SOLVER(XOR, 0.6, 1, 1),
-    SOLVER(MORSE, 0.5, 0, 0),
-    SOLVER(VIGENERE, 0.5, 0, 0),
-    SOLVER(AFFINE, 0.4, 1, 0),
-    SOLVER(RAILFENCE, 0.4, 1, 0),
-    SOLVER(BASE, 0.3, 0, 0),
-};
-
-size_t solvers_count = sizeof(solvers) / sizeof(solver_t);
+// Rail Fence decryption permutations, plain[i] = input[perm[i]], cached per (len, k, o) so every
+// node of the same length reuses them. Direct mapped, flushed whole when over the byte budget.
+typedef struct {
+    int len;
+    int k;
+    int o;
+    int * perm;
+} railfence_perm_t;
+
+static railfence_perm_t railfence_cache[RAILFENCE_CACHE_SLOTS];
+static size_t railfence_cache_bytes = 0;
+
+static void railfence_cache_flush() {
+    for (int i = 0; i < RAILFENCE_CACHE_SLOTS; i++) {
+        free(railfence_cache[i].perm);
+        railfence_cache[i].perm = NULL;
+    }
+    railfence_cache_bytes = 0;
+}
+
+// O(len): count each rail, prefix sum the rail starts, then hand out positions along the zigzag.
+// Returns 0, or -1 when out of memory.
+static int railfence_build_perm(int len, int k, int o, int * perm) {
+    int cycle_len = 2 * k - 2;
+    int * start = calloc(k, sizeof(int));
+    if (!start) return -1;
+
+    int cycle_pos = o % cycle_len;
+    for (int i = 0; i < len; i++) {
+        int row = cycle_pos < k ? cycle_pos : cycle_len - cycle_pos;
+        start[row]++;
+        if (++cycle_pos == cycle_len) cycle_pos = 0;
+    }
+
+    int offset = 0;
+    for (int r = 0; r < k; r++) {
+        int count = start[r];
+        start[r] = offset;
+        offset += count;
+    }
+
+    cycle_pos = o % cycle_len;
+    for (int i = 0; i < len; i++) {
+        int row = cycle_pos < k ? cycle_pos : cycle_len - cycle_pos;
+        perm[i] = start[row]++;
+        if (++cycle_pos == cycle_len) cycle_pos = 0;
+    }
+
+    free(start);
+    return 0;
+}
+
+static const int * railfence_perm(int len, int k, int o) {
+    unsigned int slot = ((unsigned int) len * 2654435761u ^ (unsigned int) k * 40503u ^ (unsigned int) o * 97u) % RAILFENCE_CACHE_SLOTS;
+    railfence_perm_t * entry = &railfence_cache[slot];
+    if (entry -> perm && entry -> len == len && entry -> k == k && entry -> o == o) return entry -> perm;
+
+    size_t bytes = sizeof(int) * len;
+    if (railfence_cache_bytes + bytes > RAILFENCE_CACHE_BYTES) railfence_cache_flush();
+
+    if (entry -> perm) {
+        railfence_cache_bytes -= sizeof(int) * entry -> len;
+        free(entry -> perm);
+    }
+
+    entry -> perm = malloc(bytes);
+    if (!entry -> perm) return NULL;
+    if (railfence_build_perm(len, k, o, entry -> perm) != 0) {
+        free(entry -> perm);
+        entry -> perm = NULL;
+        return NULL;
+    }
+    entry -> len = len;
+    entry -> k = k;
+    entry -> o = o;
+    railfence_cache_bytes += bytes;
+    return entry -> perm;
+}
+
+solver_fn(RAILFENCE) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    int candidates = 0;
+    int len = sdslen(input);
+    if (len < 2) return result;
+
+    // Beyond 32 rails, allow one more rail per RAILFENCE_CHARS_PER_RAIL characters
+    int max_rails = len > 32 ? 32 : (len < 4 ? len : len/2 + 2);
+    if (len / RAILFENCE_CHARS_PER_RAIL > max_rails) max_rails = len / RAILFENCE_CHARS_PER_RAIL;
+    if (max_rails > RAILFENCE_MAX_RAILS) max_rails = RAILFENCE_MAX_RAILS;
+
+    for (int k = 2; k < max_rails; k++) {
+        int cycle_len = 2 * k - 2;
+        for (int o = 0; o < cycle_len; o++) {
+            // Rail Fence Decryption with Offset, a gather through the cached permutation
+            const int * perm = railfence_perm(len, k, o);
+            if (!perm) continue;
+
+            sds plain = sdsnewlen(NULL, len);
+            for (int i = 0; i < len; i++) {
+                plain[i] = input[perm[i]];
+            }
+
+            // A transposition keeps the input's bytes, so its statistics score every candidate
+            float penalty =  ((float) k + (float) o) / (max_rails + cycle_len);
+            float fitness = score_combined_stats(stats, 1) - (penalty * PENALTY_FACTOR);
+
+            result.outputs = realloc(result.outputs, sizeof(solver_output_t) * (candidates + 1));
+            result.outputs[candidates].data = plain;
+            result.outputs[candidates].method = sdscatprintf(sdsempty(), "RAILFENCE k=%d o=%d", k, o);
+            result.outputs[candidates].fitness = fitness * SIMPLE_CIPHER_FITNESS_FACTOR;
+            candidates++;
+        }
+    }
+
+    result.len = candidates;
+    return result;
+}
+
+// Keyed columnar transposition. The plaintext is written row by row under `width` columns (the
+// last row may be short) and the columns are read out in key order. order[j] is the j-th column read.
+typedef struct {
+    float score;
+    int width;
+    int order[COLUMNAR_MAX_WIDTH];
+} columnar_key_t;
+
+// Source index in the ciphertext of every plaintext position
+static void columnar_build_source(int len, int width, const int * order, int * source) {
+    int rows = len / width;
+    int long_cols = len % width;
+    int ptr = 0;
+    for (int j = 0; j < width; j++) {
+        int col = order[j];
+        int col_len = rows + (col < long_cols ? 1 : 0);
+        for (int r = 0; r < col_len; r++) {
+            source[r * width + col] = ptr + r;
+        }
+        ptr += col_len;
+    }
+}
+
+// Only the order statistics change under transposition, so candidates are ranked on bigram
+// log-probabilities alone (quadgrams when a model is loaded), read through the source map without building the text
+static float columnar_score(const signed char * letters, int len, int width, const int * order, int * source,
+    const float (*logp)[26], const float * quad) {
+    columnar_build_source(len, width, order, source);
+
+    float score = 0.0f;
+    if (quad) {
+        // Rolling quadgram index over the letters in plaintext order, as the model was counted
+        unsigned int index = 0;
+        int run = 0;
+        for (int i = 0; i < len; i++) {
+            signed char a = letters[source[i]];
+            if (a < 0) continue;
+            index = (index % (26 * 26 * 26)) * 26 + a;
+            if (run < 3) {
+                run++;
+                continue;
+            }
+            score += quad[index];
+        }
+        return score;
+    }
+    for (int i = 0; i + 1 < len; i++) {
+        signed char a = letters[source[i]];
+        signed char b = letters[source[i + 1]];
+        if (a >= 0 && b >= 0) score += logp[a][b];
+    }
+    return score;
+}
+
+static void columnar_keep(columnar_key_t * top, int * count, float score, int width, const int * order) {
+    if (* count == COLUMNAR_TOP_KEYS && score <= top[COLUMNAR_TOP_KEYS - 1].score) return;
+
+    // Restarts often converge on the same order
+    for (int i = 0; i < * count; i++) {
+        if (top[i].width == width && memcmp(top[i].order, order, sizeof(int) * width) == 0) return;
+    }
+
+    int j = * count < COLUMNAR_TOP_KEYS ? (* count)++ : COLUMNAR_TOP_KEYS - 1;
+    while (j > 0 && top[j - 1].score < score) {
+        top[j] = top[j - 1];
+        j--;
+    }
+    top[j].score = score;
+    top[j].width = width;
+    memcpy(top[j].order, order, sizeof(int) * width);
+}
+
+typedef struct {
+    const signed char * letters;
+    int len;
+    int width;
+    const float (*logp)[26];
+    const float * quad;
+    columnar_key_t * restarts;
+} columnar_climb_t;
+
+// One hill-climbing restart: a random column order improved by swapping columns until no swap helps
+static void columnar_climb(int task, void * arg) {
+    columnar_climb_t * climb = arg;
+    int width = climb -> width;
+    int * source = malloc(sizeof(int) * climb -> len);
+    if (!source) {
+        climb -> restarts[task].score = -INFINITY;
+        return;
+    }
+
+    uint32_t rng = 0x9E3779B9u ^ (uint32_t)(task * 7919 + width);
+    int order[COLUMNAR_MAX_WIDTH];
+    for (int i = 0; i < width; i++) order[i] = i;
+    for (int i = width - 1; i > 0; i--) {
+        int r = rng_next(&rng) % (i + 1);
+        int t = order[i];
+        order[i] = order[r];
+        order[r] = t;
+    }
+
+    float best = columnar_score(climb -> letters, climb -> len, width, order, source, climb -> logp, climb -> quad);
+    int improved = 1;
+    while (improved) {
+        improved = 0;
+
+        // Swap two columns
+        for (int a = 0; a < width - 1; a++) {
+            for (int b = a + 1; b < width; b++) {
+                int t = order[a];
+                order[a] = order[b];
+                order[b] = t;
+
+                float score = columnar_score(climb -> letters, climb -> len, width, order, source, climb -> logp, climb -> quad);
+                if (score > best) {
+                    best = score;
+                    improved = 1;
+                } else {
+                    order[b] = order[a];
+                    order[a] = t;
+                }
+            }
+        }
+
+        // Move one column elsewhere, shifting the ones between. Escapes the optima where a run of
+        // adjacent columns is right but sits in the wrong place.
+        for (int a = 0; a < width; a++) {
+            for (int b = 0; b < width; b++) {
+                if (a == b) continue;
+                int moved[COLUMNAR_MAX_WIDTH];
+                memcpy(moved, order, sizeof(int) * width);
+                int t = moved[a];
+                if (a < b) memmove(&moved[a], &moved[a + 1], sizeof(int) * (b - a));
+                else memmove(&moved[b + 1], &moved[b], sizeof(int) * (a - b));
+                moved[b] = t;
+
+                float score = columnar_score(climb -> letters, climb -> len, width, moved, source, climb -> logp, climb -> quad);
+                if (score > best) {
+                    best = score;
+                    improved = 1;
+                    memcpy(order, moved, sizeof(int) * width);
+                }
+            }
+        }
+
+        // Rotate the plaintext columns, only the pairs across each row wrap change
+        for (int r = 1; r < width; r++) {
+            int moved[COLUMNAR_MAX_WIDTH];
+            for (int j = 0; j < width; j++) {
+                moved[j] = (order[j] + r) % width;
+            }
+
+            float score = columnar_score(climb -> letters, climb -> len, width, moved, source, climb -> logp, climb -> quad);
+            if (score > best) {
+                best = score;
+                improved = 1;
+                memcpy(order, moved, sizeof(int) * width);
+            }
+        }
+    }
+
+    climb -> restarts[task].score = best;
+    climb -> restarts[task].width = width;
+    memcpy(climb -> restarts[task].order, order, sizeof(int) * width);
+    free(source);
+}
+
+solver_fn(COLUMNAR) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    int len = sdslen(input);
+    if (len < COLUMNAR_MIN_LEN) return result;
+
+    signed char * letters = malloc(len);
+    int * source = malloc(sizeof(int) * len);
+    if (!letters || !source) {
+        free(letters);
+        free(source);
+        return result;
+    }
+
+    int counts[26] = {0};
+    int total = 0;
+    for (int i = 0; i < len; i++) {
+        unsigned char c = (unsigned char) input[i];
+        letters[i] = isalpha(c) ? tolower(c) - 'a' : -1;
+        if (letters[i] >= 0) {
+            counts[letters[i]]++;
+            total++;
+        }
+    }
+
+    // The letter histogram is the same for every column order: if it doesn't read as English,
+    // no transposition of it will
+    if (total < COLUMNAR_MIN_LEN || chi_squared_english(counts, total) / total > COLUMNAR_MAX_CHI) {
+        free(letters);
+        free(source);
+        return result;
+    }
+
+    const float (*logp)[26] = bigram_log_probs();
+    const float * quad = quadgram_log_probs();
+    columnar_key_t top[COLUMNAR_TOP_KEYS];
+    int top_count = 0;
+
+    int max_width = len / 2;
+    if (max_width > COLUMNAR_MAX_WIDTH) max_width = COLUMNAR_MAX_WIDTH;
+
+    // Small widths: every column order, stepped through in lexicographic order
+    for (int width = 2; width <= max_width && width <= COLUMNAR_EXHAUSTIVE_MAX; width++) {
+        int order[COLUMNAR_MAX_WIDTH];
+        for (int i = 0; i < width; i++) order[i] = i;
+
+        while (1) {
+            float score = columnar_score(letters, len, width, order, source, logp, quad);
+            columnar_keep(top, &top_count, score, width, order);
+
+            int i = width - 2;
+            while (i >= 0 && order[i] > order[i + 1]) i--;
+            if (i < 0) break;
+            int k = width - 1;
+            while (order[k] < order[i]) k--;
+            int t = order[i];
+            order[i] = order[k];
+            order[k] = t;
+            for (int a = i + 1, b = width - 1; a < b; a++, b--) {
+                t = order[a];
+                order[a] = order[b];
+                order[b] = t;
+            }
+        }
+    }
 
-solver_t * get_solvers(const char * algorithms, size_t * count) {
-    // TODO: Implement filtering based on 'algorithms' string
+    // Larger widths: multi-start hill climbing, restarts spread across threads
+    for (int width = COLUMNAR_EXHAUSTIVE_MAX + 1; width <= max_width; width++) {
+        columnar_key_t restarts[COLUMNAR_RESTARTS];
+        columnar_climb_t climb = {
+            .letters = letters,
+            .len = len,
+            .width = width,
+            .logp = logp,
+            .quad = quad,
+            .restarts = restarts
+        };
+        parallel_for(COLUMNAR_RESTARTS, columnar_climb, &climb);
+
+        for (int r = 0; r < COLUMNAR_RESTARTS; r++) {
+            if (restarts[r].score > -INFINITY) columnar_keep(top, &top_count, restarts[r].score, width, restarts[r].order);
+        }
+    }
+
+    for (int t = 0; t < top_count; t++) {
+        columnar_build_source(len, top[t].width, top[t].order, source);
+
+        sds plain = sdsnewlen(NULL, len);
+        for (int i = 0; i < len; i++) plain[i] = input[source[i]];
+
+        sds method = sdscatprintf(sdsempty(), "COLUMNAR w=%d order=", top[t].width);
+        for (int i = 0; i < top[t].width; i++) {
+            method = sdscatprintf(method, i ? "-%d" : "%d", top[t].order[i]);
+        }
+
+        float penalty = (float) t / COLUMNAR_TOP_KEYS;
+        float fitness = score_combined_stats(stats, 1) - (penalty * PENALTY_FACTOR);
+        result_push(&result, plain, method, fitness * SIMPLE_CIPHER_FITNESS_FACTOR);
+    }
+
+    free(letters);
+    free(source);
+    return result;
+}
+
+// Monoalphabetic substitution by simulated annealing over the key. key[c] is the plaintext letter
+// for ciphertext letter c. The ciphertext is reduced once to its distinct letter n-grams with counts,
+// indexed by the letters they contain, so swapping two key letters only rescores the n-grams that
+// contain either of them.
+typedef struct {
+    float score;
+    unsigned char key[26];
+} substitution_key_t;
+
+typedef struct {
+    int ngram_count;
+    unsigned char * ngrams;
+    int * weights;
+    int * by_letter[26];
+    int by_letter_len[26];
+    unsigned char present[26];
+    int present_count;
+    unsigned char seed[26];
+    int n;                   // letters per n-gram
+    const float (*logp)[26]; // bigram table, when n == SUBSTITUTION_NGRAM
+    const float * quad;      // quadgram table, when n == SUBSTITUTION_QUADGRAM
+    substitution_key_t * restarts;
+} substitution_ctx_t;
+
+static const char ENGLISH_BY_FREQUENCY[] = "etaoinshrdlcumwfgypbvkjxqz";
+
+static float substitution_ngram_score(const substitution_ctx_t * ctx, const unsigned char * key, int g) {
+    const unsigned char * ngram = ctx -> ngrams + g * ctx -> n;
+    if (ctx -> quad) {
+        int index = ((key[ngram[0]] * 26 + key[ngram[1]]) * 26 + key[ngram[2]]) * 26 + key[ngram[3]];
+        return ctx -> quad[index] * ctx -> weights[g];
+    }
+    float score = 0.0f;
+    for (int i = 0; i + 1 < ctx -> n; i++) {
+        score += ctx -> logp[key[ngram[i]]][key[ngram[i + 1]]];
+    }
+    return score * ctx -> weights[g];
+}
+
+// Score of every n-gram touched by a swap of x and y, each counted once
+static float substitution_affected_score(const substitution_ctx_t * ctx, const unsigned char * key, int x, int y) {
+    float score = 0.0f;
+    for (int i = 0; i < ctx -> by_letter_len[x]; i++) {
+        score += substitution_ngram_score(ctx, key, ctx -> by_letter[x][i]);
+    }
+    for (int i = 0; i < ctx -> by_letter_len[y]; i++) {
+        int g = ctx -> by_letter[y][i];
+        const unsigned char * ngram = ctx -> ngrams + g * ctx -> n;
+        int has_x = 0;
+        for (int k = 0; k < ctx -> n; k++) {
+            if (ngram[k] == x) has_x = 1;
+        }
+        if (!has_x) score += substitution_ngram_score(ctx, key, g);
+    }
+    return score;
+}
+
+static void substitution_anneal(int task, void * arg) {
+    substitution_ctx_t * ctx = arg;
+    uint32_t rng = 0x2545F491u ^ (uint32_t)(task * 104729 + 1);
+    float t0 = ctx -> quad ? SUBSTITUTION_QUADGRAM_T0 : SUBSTITUTION_T0;
+
+    unsigned char key[26];
+    memcpy(key, ctx -> seed, 26);
+
+    // Restart 0 keeps the frequency seed, the others start from a perturbed copy
+    for (int i = 0; task > 0 && i < SUBSTITUTION_PERTURB; i++) {
+        int a = rng_next(&rng) % 26;
+        int b = rng_next(&rng) % 26;
+        unsigned char t = key[a];
+        key[a] = key[b];
+        key[b] = t;
+    }
+
+    float score = 0.0f;
+    for (int g = 0; g < ctx -> ngram_count; g++) {
+        score += substitution_ngram_score(ctx, key, g);
+    }
+
+    substitution_key_t * best = &ctx -> restarts[task];
+    best -> score = score;
+    memcpy(best -> key, key, 26);
+
+    for (int it = 0; it < SUBSTITUTION_ITERATIONS; it++) {
+        float temperature = t0 * (1.0f - (float) it / SUBSTITUTION_ITERATIONS);
+
+        int x = ctx -> present[rng_next(&rng) % ctx -> present_count];
+        int y = rng_next(&rng) % 26;
+        if (x == y) continue;
+
+        float before = substitution_affected_score(ctx, key, x, y);
+        unsigned char t = key[x];
+        key[x] = key[y];
+        key[y] = t;
+        float delta = substitution_affected_score(ctx, key, x, y) - before;
+
+        float r = (float)(rng_next(&rng) & 0xFFFFFF) / 0x1000000;
+        if (delta >= 0.0f || (temperature > 0.0f && r < expf(delta / temperature))) {
+            score += delta;
+            if (score > best -> score) {
+                best -> score = score;
+                memcpy(best -> key, key, 26);
+            }
+        } else {
+            key[y] = key[x];
+            key[x] = t;
+        }
+    }
+}
+
+solver_fn(SUBSTITUTION) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    int len = sdslen(input);
+    unsigned char * letters = malloc(len > 0 ? len : 1);
+    if (!letters) return result;
+
+    int n = 0;
+    int counts[26] = {0};
+    for (int i = 0; i < len; i++) {
+        if (isalpha((unsigned char) input[i])) {
+            letters[n] = tolower((unsigned char) input[i]) - 'a';
+            counts[letters[n]]++;
+            n++;
+        }
+    }
+
+    // A monoalphabetic key keeps English's IoC but scrambles its letter frequencies
+    if (n < SUBSTITUTION_MIN_LETTERS || index_of_coincidence(counts, n) < SUBSTITUTION_MIN_IOC
+        || chi_squared_english(counts, n) / n < SUBSTITUTION_MIN_CHI) {
+        free(letters);
+        return result;
+    }
+
+    substitution_ctx_t ctx = { 0 };
+    ctx.logp = bigram_log_probs();
+    ctx.quad = quadgram_log_probs();
+    ctx.n = ctx.quad ? SUBSTITUTION_QUADGRAM : SUBSTITUTION_NGRAM;
+
+    // Distinct n-grams with their counts
+    int space = 1;
+    for (int i = 0; i < ctx.n; i++) space *= ALPHABET_SIZE;
+    int * ids = malloc(sizeof(int) * space);
+    ctx.ngrams = malloc(n * ctx.n);
+    ctx.weights = malloc(sizeof(int) * n);
+    if (!ids || !ctx.ngrams || !ctx.weights) {
+        free(ids);
+        free(ctx.ngrams);
+        free(ctx.weights);
+        free(letters);
+        return result;
+    }
+    memset(ids, -1, sizeof(int) * space);
+
+    for (int i = 0; i + ctx.n <= n; i++) {
+        int index = 0;
+        for (int k = 0; k < ctx.n; k++) index = index * ALPHABET_SIZE + letters[i + k];
+        if (ids[index] < 0) {
+            ids[index] = ctx.ngram_count;
+            memcpy(ctx.ngrams + ctx.ngram_count * ctx.n, letters + i, ctx.n);
+            ctx.weights[ctx.ngram_count++] = 0;
+        }
+        ctx.weights[ids[index]]++;
+    }
+    free(ids);
+
+    for (int c = 0; c < 26; c++) {
+        ctx.by_letter[c] = malloc(sizeof(int) * (ctx.ngram_count > 0 ? ctx.ngram_count : 1));
+        if (!ctx.by_letter[c]) {
+            while (c-- > 0) free(ctx.by_letter[c]);
+            free(ctx.ngrams);
+            free(ctx.weights);
+            free(letters);
+            return result;
+        }
+    }
+    for (int g = 0; g < ctx.ngram_count; g++) {
+        const unsigned char * ngram = ctx.ngrams + g * ctx.n;
+        for (int k = 0; k < ctx.n; k++) {
+            int c = ngram[k];
+            int seen = 0;
+            for (int m = 0; m < k; m++) {
+                if (ngram[m] == c) seen = 1;
+            }
+            if (!seen) ctx.by_letter[c][ctx.by_letter_len[c]++] = g;
+        }
+    }
+
+    // Seed: ciphertext letters by frequency onto English letters by frequency
+    unsigned char by_count[26];
+    for (int c = 0; c < 26; c++) by_count[c] = c;
+    for (int a = 1; a < 26; a++) {
+        unsigned char c = by_count[a];
+        int b = a;
+        while (b > 0 && counts[by_count[b - 1]] < counts[c]) {
+            by_count[b] = by_count[b - 1];
+            b--;
+        }
+        by_count[b] = c;
+    }
+    for (int r = 0; r < 26; r++) {
+        ctx.seed[by_count[r]] = ENGLISH_BY_FREQUENCY[r] - 'a';
+        if (counts[by_count[r]] > 0) ctx.present[ctx.present_count++] = by_count[r];
+    }
+
+    substitution_key_t restarts[SUBSTITUTION_RESTARTS];
+    ctx.restarts = restarts;
+    parallel_for(SUBSTITUTION_RESTARTS, substitution_anneal, &ctx);
+
+    // Converged keys, best first and without duplicates
+    substitution_key_t top[SUBSTITUTION_TOP_KEYS];
+    int top_count = 0;
+    for (int r = 0; r < SUBSTITUTION_RESTARTS; r++) {
+        int duplicate = 0;
+        for (int t = 0; t < top_count; t++) {
+            if (memcmp(top[t].key, restarts[r].key, 26) == 0) duplicate = 1;
+        }
+        if (duplicate) continue;
+        if (top_count == SUBSTITUTION_TOP_KEYS && restarts[r].score <= top[SUBSTITUTION_TOP_KEYS - 1].score) continue;
+
+        int j = top_count < SUBSTITUTION_TOP_KEYS ? top_count++ : SUBSTITUTION_TOP_KEYS - 1;
+        while (j > 0 && top[j - 1].score < restarts[r].score) {
+            top[j] = top[j - 1];
+            j--;
+        }
+        top[j] = restarts[r];
+    }
+
+    for (int t = 0; t < top_count; t++) {
+        sds plain = sdsdup(input);
+        for (int i = 0; i < len; i++) {
+            unsigned char c = (unsigned char) plain[i];
+            if (isupper(c)) plain[i] = 'A' + top[t].key[c - 'A'];
+            else if (islower(c)) plain[i] = 'a' + top[t].key[c - 'a'];
+        }
+
+        char key_str[27];
+        for (int c = 0; c < 26; c++) key_str[c] = 'a' + top[t].key[c];
+        key_str[26] = '\0';
+
+        float penalty = (float) t / SUBSTITUTION_TOP_KEYS;
+        float fitness = score_combined(plain, len, 1) - (penalty * PENALTY_FACTOR);
+        result_push(&result, plain, sdscatprintf(sdsempty(), "SUBSTITUTION(%s)", key_str),
+            fitness * SIMPLE_CIPHER_FITNESS_FACTOR);
+    }
+
+    for (int c = 0; c < 26; c++) free(ctx.by_letter[c]);
+    free(ctx.ngrams);
+    free(ctx.weights);
+    free(letters);
+    return result;
+}
+
+// Digit value of a base-36 numeral character, -1 when it is not one
+static int base_digit(char c) {
+    if (isdigit((unsigned char) c)) return c - '0';
+    if (islower((unsigned char) c)) return c - 'a' + 10;
+    if (isupper((unsigned char) c)) return c - 'A' + 10;
+    return -1;
+}
+
+// limbs = limbs * mul + add over little-endian 32-bit limbs, returns the new limb count
+static size_t bignum_muladd(uint32_t * limbs, size_t n, uint32_t mul, uint32_t add) {
+    uint64_t carry = add;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t v = (uint64_t) limbs[i] * mul + carry;
+        limbs[i] = (uint32_t) v;
+        carry = v >> 32;
+    }
+    if (carry) limbs[n++] = (uint32_t) carry;
+    return n;
+}
+
+// limbs /= div in place, returns the remainder and trims leading zero limbs
+static uint32_t bignum_divmod(uint32_t * limbs, size_t * n, uint32_t div) {
+    uint64_t rem = 0;
+    for (size_t i = *n; i-- > 0;) {
+        uint64_t v = (rem << 32) | limbs[i];
+        limbs[i] = (uint32_t) (v / div);
+        rem = v % div;
+    }
+    while (*n > 0 && limbs[*n - 1] == 0) (*n)--;
+    return (uint32_t) rem;
+}
+
+// Parse pre-classified digits in the given base, folding as many digits per pass as fit a limb
+static size_t bignum_from_digits(uint32_t * limbs, const unsigned char * digits, size_t len, int base) {
+    int chunk = 1;
+    uint32_t chunk_mul = base;
+    while ((uint64_t) chunk_mul * base <= UINT32_MAX) {
+        chunk_mul *= base;
+        chunk++;
+    }
+
+    size_t n = 0;
+    size_t head = len % chunk;
+    size_t i = 0;
+    while (i < len) {
+        size_t take = (i == 0 && head) ? head : (size_t) chunk;
+        uint32_t mul = 1;
+        uint32_t add = 0;
+        for (size_t j = 0; j < take; j++) {
+            mul *= base;
+            add = add * base + digits[i + j];
+        }
+        n = bignum_muladd(limbs, n, mul, add);
+        i += take;
+    }
+    while (n > 0 && limbs[n - 1] == 0) n--;
+    return n;
+}
+
+// Decimal string of the number, consumes the limbs. NULL when out of memory.
+static sds bignum_to_decimal(uint32_t * limbs, size_t n) {
+    if (n == 0) return sdsnew("0");
+
+    size_t max_groups = n * 32 / 29 + 2; // 10^9 > 2^29
+    uint32_t * groups = malloc(sizeof(uint32_t) * max_groups);
+    if (!groups) return NULL;
+    size_t g = 0;
+    while (n > 0) groups[g++] = bignum_divmod(limbs, &n, 1000000000u);
+
+    sds out = sdscatprintf(sdsempty(), "%u", groups[g - 1]);
+    for (size_t i = g - 1; i-- > 0;) out = sdscatprintf(out, "%09u", groups[i]);
+    free(groups);
+    return out;
+}
+
+// Big-endian bytes of the number without leading zeros, NULL unless they read as text.
+// Every base yields some payload, only a printable one is a plausible encoding.
+static sds bignum_to_text(const uint32_t * limbs, size_t n) {
+    sds out = sdsempty();
+    int started = 0;
+    for (size_t i = n; i-- > 0;) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            unsigned char byte = (unsigned char) (limbs[i] >> shift);
+            if (!started && byte == 0) continue;
+            if (!isprint(byte) && byte != '\n' && byte != '\r' && byte != '\t') {
+                sdsfree(out);
+                return NULL;
+            }
+            started = 1;
+            out = sdscatlen(out, &byte, 1);
+        }
+    }
+    if (sdslen(out) == 0) {
+        sdsfree(out);
+        return NULL;
+    }
+    return out;
+}
+
+solver_fn(BASE) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    size_t len = sdslen(input);
+    if (len == 0 || len > BASE_MAX_DIGITS) return result;
+
+    // Classify once; the largest digit gives the smallest base the numeral can be in
+    unsigned char * digits = malloc(len);
+    if (!digits) return result;
+    int max_digit = 0;
+    for (size_t i = 0; i < len; i++) {
+        int val = base_digit(input[i]);
+        if (val < 0) {
+            free(digits);
+            return result;
+        }
+        digits[i] = (unsigned char) val;
+        if (val > max_digit) max_digit = val;
+    }
+
+    // log2(36) < 6 bits per digit, plus room for the final carry
+    size_t max_limbs = len * 6 / 32 + 2;
+    uint32_t * limbs = malloc(sizeof(uint32_t) * max_limbs);
+    if (!limbs) {
+        free(digits);
+        return result;
+    }
+    int min_base = max_digit < 1 ? 2 : max_digit + 1;
+
+    for (int base = min_base; base <= 36; base++) {
+        size_t n = bignum_from_digits(limbs, digits, len, base);
+        float penalty = ((float) base) / 36.0f;
+
+        sds text = bignum_to_text(limbs, n);
+        if (text) {
+            result_push(&result, text, sdscatprintf(sdsempty(), "BASE (base %d bytes)", base),
+                score_combined(text, sdslen(text), 0) - (penalty * PENALTY_FACTOR));
+        }
+
+        if (n > BASE_MAX_DECIMAL / 9 + 2) continue; // a limb carries over 9 decimal digits
+        sds decimal_str = bignum_to_decimal(limbs, n);
+        if (!decimal_str) break;
+        if (sdslen(decimal_str) > BASE_MAX_DECIMAL) {
+            sdsfree(decimal_str);
+            continue;
+        }
+        result_push(&result, decimal_str, sdscatprintf(sdsempty(), "BASE (base %d)", base),
+            score_combined(decimal_str, sdslen(decimal_str), 0) - (penalty * PENALTY_FACTOR));
+    }
+
+    free(limbs);
+    free(digits);
+    return result;
+}
+
+// Single pass over the input: symbols build a tree index, spaces end a letter and word
+// delimiters end a word. Letters with foreign bytes or unknown codes are counted and dropped.
+static sds morse_decode(const char * input, size_t len, const morse_symbols_t * symbols, int * total_out, int * valid_out) {
+    sds plain = sdsnewlen(NULL, len + 1);
+    size_t out = 0;
+    int total = 0;
+    int valid = 0;
+
+    unsigned int code = 1;
+    int symbols_seen = 0;
+    int bad = 0;
+
+    for (size_t i = 0; i <= len; i++) {
+        char c = i < len ? input[i] : '/';
+
+        if (c == symbols -> dot || c == symbols -> dash) {
+            code = (code << 1) | (c == symbols -> dash);
+            symbols_seen++;
+            continue;
+        }
+
+        int word_end = c == '/' || c == '\\' || c == '\n' || c == '\r' || c == ',' || c == ';' || c == ':';
+        if (!word_end && c != ' ' && c != '\t') {
+            bad = 1;
+            continue;
+        }
+
+        if (symbols_seen > 0 || bad) {
+            char decoded = (!bad && symbols_seen <= MORSE_MAX_SYMBOLS) ? MORSE_DECODE[code] : 0;
+            if (decoded) {
+                plain[out++] = decoded;
+                valid++;
+            }
+            total++;
+        }
+        code = 1;
+        symbols_seen = 0;
+        bad = 0;
+
+        if (word_end && out > 0 && plain[out - 1] != ' ') plain[out++] = ' ';
+    }
+    if (out > 0 && plain[out - 1] == ' ') out--;
+
+    sdssetlen(plain, out);
+    plain[out] = '\0';
+    * total_out = total;
+    * valid_out = valid;
+    return plain;
+}
+
+solver_fn(MORSE) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    size_t len = sdslen(input);
+    for (size_t p = 0; p < sizeof(MORSE_SYMBOLS) / sizeof(MORSE_SYMBOLS[0]); p++) {
+        const morse_symbols_t * symbols = & MORSE_SYMBOLS[p];
+        if (p > 0 && !memchr(input, symbols -> dash, len)) continue;
+
+        int total_chars = 0;
+        int valid_chars = 0;
+        sds plain = morse_decode(input, len, symbols, & total_chars, & valid_chars);
+
+        float prob = total_chars ? (float) valid_chars / (float) total_chars : 0.0f;
+        if (prob < (p > 0 ? 1.0f : 0.5f)) {
+            sdsfree(plain);
+            continue;
+        }
+        result_push(& result, plain, sdsnew(symbols -> label), prob);
+    }
+
+    return result;
+}
+
+// A recovered plaintext must come out fully printable, anything less is a near miss on random bytes
+static int xor_histogram_printable(const int counts[256]) {
+    for (int c = 0; c < 256; c++) {
+        if (counts[c] && !isprint(c) && c != '\n' && c != '\r' && c != '\t') return 0;
+    }
+    return 1;
+}
+
+// Byte that best turns a column XORed with one key byte back into English-like text
+static int xor_best_byte(const int counts[256], int total) {
+    int best = 0;
+    float best_score = -1.0f;
+    for (int k = 0; k < 256; k++) {
+        int shifted[256];
+        for (int c = 0; c < 256; c++) shifted[c ^ k] = counts[c];
+
+        float score = score_byte_histogram(shifted, total);
+        if (score > best_score) {
+            best_score = score;
+            best = k;
+        }
+    }
+    return best;
+}
+
+// Mean Hamming distance per byte between consecutive key-sized blocks, lowest at the key length
+static float xor_keysize_distance(const unsigned char * data, int len, int keysize) {
+    int blocks = len / keysize - 1;
+    if (blocks > XOR_HAMMING_BLOCKS) blocks = XOR_HAMMING_BLOCKS;
+
+    long bits = 0;
+    for (int b = 0; b < blocks; b++) {
+        const unsigned char * x = data + b * keysize;
+        const unsigned char * y = x + keysize;
+        for (int i = 0; i < keysize; i++) bits += __builtin_popcount(x[i] ^ y[i]);
+    }
+    return (float) bits / ((float) blocks * keysize);
+}
+
+// XOR(key) for printable keys, XOR(0x..) otherwise
+static sds xor_key_method(const unsigned char * key, int key_len) {
+    int printable = 1;
+    for (int i = 0; i < key_len; i++) {
+        if (!isgraph(key[i])) printable = 0;
+    }
+
+    sds method = sdsnew("XOR(");
+    if (printable) {
+        method = sdscatlen(method, key, key_len);
+    } else {
+        method = sdscat(method, "0x");
+        for (int i = 0; i < key_len; i++) method = sdscatprintf(method, "%02x", key[i]);
+    }
+    return sdscat(method, ")");
+}
+
+static void xor_push_key(solver_result_t * result, sds input, const unsigned char * key, int key_len, int rank) {
+    int input_len = sdslen(input);
+    sds output = sdsnewlen(NULL, input_len);
+    for (int i = 0; i < input_len; i++) {
+        output[i] = input[i] ^ key[i % key_len];
+    }
+
+    sds method = xor_key_method(key, key_len);
+
+    float penalty = ((float) rank) / XOR_TOP_KEYS;
+    float fitness = score_combined(output, input_len, 0) - (penalty * PENALTY_FACTOR);
+    result_push(result, output, method, fitness);
+}
+
+// Keyless recovery for binary blobs: every single-byte key ranked from one histogram, then
+// repeating keys whose length is guessed from normalised Hamming distance, solved column by column
+static void xor_recover_keys(sds input, const text_stats_t * stats, solver_result_t * result) {
+    int len = sdslen(input);
+    if (len < XOR_MIN_LEN) return;
+
+    // Printable text XORed with a printable key is rarely printable, so printable input has no XOR layer to peel
+    if (stats -> non_printable == 0) return;
+
+    const unsigned char * data = (const unsigned char *) input;
+    const int * counts = stats -> counts;
+
+    int single_keys[XOR_TOP_KEYS];
+    float single_scores[XOR_TOP_KEYS];
+    int single_count = 0;
+    for (int k = 1; k < 256; k++) {
+        int shifted[256];
+        for (int c = 0; c < 256; c++) shifted[c ^ k] = counts[c];
+
+        float score = score_byte_histogram(shifted, len);
+        if (score < XOR_MIN_SCORE || !xor_histogram_printable(shifted)) continue;
+        if (single_count == XOR_TOP_KEYS && score <= single_scores[XOR_TOP_KEYS - 1]) continue;
+
+        int j = single_count < XOR_TOP_KEYS ? single_count++ : XOR_TOP_KEYS - 1;
+        while (j > 0 && single_scores[j - 1] < score) {
+            single_scores[j] = single_scores[j - 1];
+            single_keys[j] = single_keys[j - 1];
+            j--;
+        }
+        single_scores[j] = score;
+        single_keys[j] = k;
+    }
+
+    for (int r = 0; r < single_count; r++) {
+        unsigned char key = (unsigned char) single_keys[r];
+        xor_push_key(result, input, &key, 1, r);
+    }
+
+    int max_keysize = len / 4;
+    if (max_keysize > XOR_MAX_KEYSIZE) max_keysize = XOR_MAX_KEYSIZE;
+
+    int keysizes[XOR_TOP_KEYSIZES];
+    float distances[XOR_TOP_KEYSIZES];
+    int keysize_count = 0;
+    for (int ks = 2; ks <= max_keysize; ks++) {
+        float d = xor_keysize_distance(data, len, ks);
+        if (keysize_count == XOR_TOP_KEYSIZES && d >= distances[XOR_TOP_KEYSIZES - 1]) continue;
+
+        int j = keysize_count < XOR_TOP_KEYSIZES ? keysize_count++ : XOR_TOP_KEYSIZES - 1;
+        while (j > 0 && distances[j - 1] > d) {
+            distances[j] = distances[j - 1];
+            keysizes[j] = keysizes[j - 1];
+            j--;
+        }
+        distances[j] = d;
+        keysizes[j] = ks;
+    }
+
+    // As with VIGENERE_CRACK, a keysize the autocorrelation (XOR_PERIOD analyzer) singles out goes first
+    float lift;
+    int hinted = hamming_period(data, len, max_keysize, &lift);
+    if (hinted > 0) promote_first(keysizes, &keysize_count, XOR_TOP_KEYSIZES, hinted);
+
+    unsigned char keys[XOR_TOP_KEYSIZES][XOR_MAX_KEYSIZE];
+    int key_lens[XOR_TOP_KEYSIZES];
+    float key_scores[XOR_TOP_KEYSIZES];
+    int key_count = 0;
+    for (int r = 0; r < keysize_count; r++) {
+        int ks = keysizes[r];
+        unsigned char key[XOR_MAX_KEYSIZE];
+
+        // Transpose into columns, each one is a single-byte XOR
+        int plain_counts[256] = {0};
+        for (int col = 0; col < ks; col++) {
+            int col_counts[256] = {0};
+            int total = 0;
+            for (int i = col; i < len; i += ks) {
+                col_counts[data[i]]++;
+                total++;
+            }
+            key[col] = (unsigned char) xor_best_byte(col_counts, total);
+            for (int c = 0; c < 256; c++) plain_counts[c ^ key[col]] += col_counts[c];
+        }
+
+        // Must read better than the best single-byte key, which it would otherwise just approximate
+        float score = score_byte_histogram(plain_counts, len);
+        if (score < XOR_MIN_SCORE || !xor_histogram_printable(plain_counts)) continue;
+        if (single_count > 0 && score <= single_scores[0]) continue;
+
+        int key_len = vigenere_reduce_key((const char *) key, ks);
+        if (key_len < 2) continue;
+
+        int duplicate = 0;
+        for (int k = 0; k < key_count; k++) {
+            if (key_lens[k] == key_len && memcmp(keys[k], key, key_len) == 0) duplicate = 1;
+        }
+        if (duplicate) continue;
+
+        // Keep the recovered keys ordered by how well they read
+        int j = key_count++;
+        while (j > 0 && key_scores[j - 1] < score) {
+            memcpy(keys[j], keys[j - 1], key_lens[j - 1]);
+            key_lens[j] = key_lens[j - 1];
+            key_scores[j] = key_scores[j - 1];
+            j--;
+        }
+        memcpy(keys[j], key, key_len);
+        key_lens[j] = key_len;
+        key_scores[j] = score;
+    }
+
+    for (int k = 0; k < key_count; k++) {
+        xor_push_key(result, input, keys[k], key_lens[k], k);
+    }
+}
+
+// English likeness of input ^ key from its histogram alone
+static float xor_key_score(sds input, const char * key, int key_len) {
+    int counts[256] = {0};
+    int input_len = sdslen(input);
+    for (int i = 0, k = 0; i < input_len; i++) {
+        counts[(unsigned char) (input[i] ^ key[k])]++;
+        if (++k == key_len) k = 0;
+    }
+    return score_byte_histogram(counts, input_len);
+}
+
+static solver_result_t solve_XOR(sds input, keychain_t * keychain, const text_stats_t * stats) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    int input_len = sdslen(input);
+    int best[KEYED_TOP_K];
+    int survivors = keyed_scan(input, keychain, xor_key_score, best);
+
+    for (int r = 0; r < survivors; r++) {
+        const char * key = keychain -> keys[best[r]].data;
+        int key_len = (int) keychain -> keys[best[r]].len;
+
+        sds output = sdsnewlen(NULL, input_len);
+        for (int i = 0; i < input_len; i++) {
+            output[i] = input[i] ^ key[i % key_len];
+        }
+
+        float penalty = ((float) r) / survivors;
+        float fitness = score_combined(output, input_len, 0) - (penalty * PENALTY_FACTOR);
+
+        result_push(&result, output, sdscatprintf(sdsempty(), "XOR(%.*s)", key_len, key), fitness);
+    }
+
+    xor_recover_keys(input, stats, &result);
+    return result;
+}
+
+// Known-plaintext key derivation. Sliding the crib along the ciphertext gives, at every offset, the key
+// stream that would turn it into the crib (c ^ p for XOR, c - p for Vigenere). Where that stream repeats
+// with some period the key is read straight off, so a few offsets yield a handful of exact keys.
+typedef struct {
+    const unsigned char * cipher;
+    int n;
+    const unsigned char * crib;
+    int m;
+    int modulus; // 256 = XOR over bytes, 26 = Vigenere over letters
+    int chunk;
+    int * periods; // per offset, 0 = no periodic key
+} crib_drag_t;
+
+static inline unsigned char crib_key_symbol(const crib_drag_t * drag, int offset, int i) {
+    if (drag -> modulus == 256) return drag -> cipher[offset + i] ^ drag -> crib[i];
+    return (unsigned char) ((drag -> cipher[offset + i] - drag -> crib[i] + 26) % 26);
+}
+
+static void crib_drag_task(int task, void * ctx) {
+    crib_drag_t * drag = ctx;
+    int offsets = drag -> n - drag -> m + 1;
+    int end = (task + 1) * drag -> chunk;
+    if (end > offsets) end = offsets;
+
+    unsigned char stream[CRIB_MAX_LEN];
+    for (int o = task * drag -> chunk; o < end; o++) {
+        for (int i = 0; i < drag -> m; i++) stream[i] = crib_key_symbol(drag, o, i);
+
+        // Smallest period the rest of the crib confirms
+        drag -> periods[o] = 0;
+        for (int p = 1; p + CRIB_MIN_REPEAT <= drag -> m; p++) {
+            int i = 0;
+            while (i + p < drag -> m && stream[i] == stream[i + p]) i++;
+            if (i + p == drag -> m) {
+                drag -> periods[o] = p;
+                break;
+            }
+        }
+    }
+}
+
+// Distinct keys, each aligned to position 0 of the cipher and reduced to its shortest period.
+// Returns how many were written to keys (CRIB_MAX_CANDIDATES x CRIB_MAX_LEN).
+static int crib_drag(crib_drag_t * drag, unsigned char keys[][CRIB_MAX_LEN], int * key_lens) {
+    int offsets = drag -> n - drag -> m + 1;
+    if (drag -> m < CRIB_MIN_REPEAT + 1 || offsets <= 0) return 0;
+
+    drag -> periods = malloc(sizeof(int) * offsets);
+    if (!drag -> periods) return 0;
+
+    int tasks = 1;
+    if ((long) offsets * drag -> m >= CRIB_PARALLEL_MIN) tasks = cpu_count() * 4;
+    if (tasks > offsets) tasks = offsets;
+    drag -> chunk = (offsets + tasks - 1) / tasks;
+    if (tasks > 1) parallel_for(tasks, crib_drag_task, drag);
+    else crib_drag_task(0, drag);
+
+    int key_count = 0;
+    for (int o = 0; o < offsets && key_count < CRIB_MAX_CANDIDATES; o++) {
+        int p = drag -> periods[o];
+        if (p == 0) continue;
+
+        unsigned char key[CRIB_MAX_LEN];
+        for (int i = 0; i < p; i++) key[(o + i) % p] = crib_key_symbol(drag, o, i);
+        p = vigenere_reduce_key((const char *) key, p);
+
+        int duplicate = 0;
+        for (int k = 0; k < key_count && !duplicate; k++) {
+            duplicate = key_lens[k] == p && memcmp(keys[k], key, p) == 0;
+        }
+        if (duplicate) continue;
+        memcpy(keys[key_count], key, p);
+        key_lens[key_count++] = p;
+    }
+
+    free(drag -> periods);
+    return key_count;
+}
+
+// Keeps the best CRIB_TOP_KEYS outputs by English likeness, best first
+typedef struct {
+    sds outputs[CRIB_TOP_KEYS];
+    sds methods[CRIB_TOP_KEYS];
+    float scores[CRIB_TOP_KEYS];
+    int count;
+} crib_top_t;
+
+static void crib_top_offer(crib_top_t * top, sds output, sds method, float score) {
+    if (top -> count == CRIB_TOP_KEYS && score <= top -> scores[CRIB_TOP_KEYS - 1]) {
+        sdsfree(output);
+        sdsfree(method);
+        return;
+    }
+    if (top -> count == CRIB_TOP_KEYS) {
+        sdsfree(top -> outputs[CRIB_TOP_KEYS - 1]);
+        sdsfree(top -> methods[CRIB_TOP_KEYS - 1]);
+    }
+
+    int j = top -> count < CRIB_TOP_KEYS ? top -> count++ : CRIB_TOP_KEYS - 1;
+    while (j > 0 && top -> scores[j - 1] < score) {
+        top -> outputs[j] = top -> outputs[j - 1];
+        top -> methods[j] = top -> methods[j - 1];
+        top -> scores[j] = top -> scores[j - 1];
+        j--;
+    }
+    top -> outputs[j] = output;
+    top -> methods[j] = method;
+    top -> scores[j] = score;
+}
+
+static solver_result_t crib_top_result(crib_top_t * top, float fitness_factor) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+    for (int r = 0; r < top -> count; r++) {
+        float penalty = ((float) r) / CRIB_TOP_KEYS;
+        float fitness = score_combined(top -> outputs[r], sdslen(top -> outputs[r]), 0) - (penalty * PENALTY_FACTOR);
+        result_push(&result, top -> outputs[r], top -> methods[r], fitness * fitness_factor);
+    }
+    return result;
+}
+
+solver_fn(XOR_CRIB) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+    if (!keychain || !keychain -> crib) return result;
+
+    int n = sdslen(input);
+    int m = strlen(keychain -> crib);
+    if (m > CRIB_MAX_LEN) m = CRIB_MAX_LEN;
+
+    crib_drag_t drag = {
+        .cipher = (const unsigned char *) input,
+        .n = n,
+        .crib = (const unsigned char *) keychain -> crib,
+        .m = m,
+        .modulus = 256,
+    };
+    unsigned char keys[CRIB_MAX_CANDIDATES][CRIB_MAX_LEN];
+    int key_lens[CRIB_MAX_CANDIDATES];
+    int key_count = crib_drag(&drag, keys, key_lens);
+
+    crib_top_t top = { .count = 0 };
+    for (int k = 0; k < key_count; k++) {
+        // The zero key is the crib already sitting in the input
+        int zero = 1;
+        for (int i = 0; i < key_lens[k]; i++) zero &= keys[k][i] == 0;
+        if (zero) continue;
+
+        int counts[256];
+        sds output = sdsnewlen(NULL, n);
+        for (int i = 0; i < n; i++) output[i] = input[i] ^ keys[k][i % key_lens[k]];
+        byte_histogram(output, n, counts);
+        if (!xor_histogram_printable(counts)) {
+            sdsfree(output);
+            continue;
+        }
+
+        crib_top_offer(&top, output, xor_key_method(keys[k], key_lens[k]), score_byte_histogram(counts, n));
+    }
+
+    return crib_top_result(&top, 1.0f);
+}
+
+solver_fn(VIGENERE_CRIB) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+    if (!keychain || !keychain -> crib) return result;
+
+    // Vigenere keys only step over letters, so both sides are dragged as letter streams
+    unsigned char crib[CRIB_MAX_LEN];
+    int m = 0;
+    for (const char * c = keychain -> crib; * c && m < CRIB_MAX_LEN; c++) {
+        if (isalpha((unsigned char) * c)) crib[m++] = tolower((unsigned char) * c) - 'a';
+    }
+
+    int input_len = sdslen(input);
+    unsigned char * letters = malloc(input_len > 0 ? input_len : 1);
+    if (!letters) return result;
+    int n = 0;
+    for (int i = 0; i < input_len; i++) {
+        if (isalpha((unsigned char) input[i])) letters[n++] = tolower((unsigned char) input[i]) - 'a';
+    }
+
+    crib_drag_t drag = {
+        .cipher = letters,
+        .n = n,
+        .crib = crib,
+        .m = m,
+        .modulus = 26,
+    };
+    unsigned char keys[CRIB_MAX_CANDIDATES][CRIB_MAX_LEN];
+    int key_lens[CRIB_MAX_CANDIDATES];
+    int key_count = crib_drag(&drag, keys, key_lens);
+    free(letters);
+
+    crib_top_t top = { .count = 0 };
+    for (int k = 0; k < key_count; k++) {
+        if (key_lens[k] == 1 && keys[k][0] == 0) continue;
+
+        char key[CRIB_MAX_LEN + 1];
+        for (int i = 0; i < key_lens[k]; i++) key[i] = 'A' + keys[k][i];
+        key[key_lens[k]] = '\0';
+
+        sds output = vigenere_decrypt(input, key, key_lens[k]);
+        int counts[256];
+        byte_histogram(output, sdslen(output), counts);
+        crib_top_offer(&top, output, sdscatprintf(sdsempty(), "VIGENERE(%s)", key), score_byte_histogram(counts, sdslen(output)));
+    }
+
+    return crib_top_result(&top, SIMPLE_CIPHER_FITNESS_FACTOR);
+}
+
+// Reverses a whole-node digest through the -x index, a no-op without one
+solver_fn(HASH_LOOKUP) {
+    solver_result_t result = {
+        .len = 0,
+        .outputs = NULL,
+    };
+
+    const char * algo;
+    key_view_t plain;
+    if (!hash_index_lookup(keychain -> index, input, sdslen(input), & algo, & plain)) return result;
+
+    sds data = sdsnewlen(plain.data, plain.len);
+    result_push(&result, data, sdscatprintf(sdsempty(), "HASH_LOOKUP(%s)", algo), score_combined(data, plain.len, 0));
+    return result;
+}
+
+solver_t solvers[] = {
+    SOLVER(HEX, 1, 0, 0, ENCODING),
+    SOLVER(BASE64, 1, 0, 0, ENCODING),
+    SOLVER(BASE32, 0.75, 0, 0, ENCODING),
+    SOLVER(BASE58, 0.5, 0, 0, ENCODING),
+    SOLVER(BASE85, 0.5, 0, 0, ENCODING),
+    SOLVER(BASE91, 0.4, 0, 0, ENCODING),
+    LAZY_SOLVER(INFLATE, 0.5, 0, 1, ENCODING),
+    SOLVER(BINARY, 0.75, 0, 0, ENCODING),
+    SOLVER(OCTAL, 0.75, 0, 0, ENCODING),
+    SOLVER(XOR, 0.6, 1, 1, KEYED),
+    SOLVER(XOR_CRIB, 0.6, 1, 1, KEYED),
+    SOLVER(MORSE, 0.5, 0, 0, ENCODING),
+    SOLVER(VIGENERE, 0.5, 0, 0, KEYED),
+    SOLVER(VIGENERE_CRACK, 0.5, 1, 0, KEYED),
+    SOLVER(VIGENERE_CRIB, 0.5, 1, 0, KEYED),
+    SOLVER(ROT, 0.75, 1, 0, CLASSICAL),
+    SOLVER(ROT47, 0.4, 1, 0, CLASSICAL),
+    SOLVER(ROT5, 0.25, 1, 0, CLASSICAL),
+    SOLVER(BYTEMAP, 0.4, 1, 0, CLASSICAL),
+    SOLVER(REVERSE, 0.4, 1, 1, TRANSFORM),
+    SOLVER(NIBBLE_SWAP, 0.25, 1, 1, TRANSFORM),
+    SOLVER(BIT_REVERSE, 0.25, 1, 1, TRANSFORM),
+    SOLVER(ENDIAN16, 0.25, 1, 1, TRANSFORM),
+    SOLVER(ENDIAN32, 0.25, 1, 1, TRANSFORM),
+    SOLVER(AFFINE, 0.4, 1, 0, CLASSICAL),
+    SOLVER(RAILFENCE, 0.4, 1, 0, CLASSICAL),
+    SOLVER(COLUMNAR, 0.4, 1, 0, CLASSICAL),
+    SOLVER(SUBSTITUTION, 0.4, 1, 0, CLASSICAL),
+    SOLVER(BASE, 0.3, 1, 0, ENCODING),
+    SOLVER(HASH_LOOKUP, 1, 1, 0, KEYED),
+};
+
+size_t solvers_count = sizeof(solvers) / sizeof(solver_t);
+_Static_assert(sizeof(solvers) / sizeof(solver_t) <= 64, "solver_mask_t holds one bit per solver");
+
+static const struct {
+    const char * name;
+    int group;
+} SOLVER_GROUP_NAMES[] = {
+    { "encodings", SOLVER_GROUP_ENCODING },
+    { "classical", SOLVER_GROUP_CLASSICAL },
+    { "keyed", SOLVER_GROUP_KEYED },
+    { "transforms", SOLVER_GROUP_TRANSFORM },
+};
+
+static solver_mask_t group_mask(int groups) {
+    solver_mask_t mask = 0;
+    for (size_t i = 0; i < solvers_count; i++) {
+        if (solvers[i].groups & groups) mask |= SOLVER_BIT(i);
+    }
+    return mask;
+}
+
+static solver_mask_t label_mask(const char * label, size_t len) {
+    for (size_t i = 0; i < solvers_count; i++) {
+        if (strlen(solvers[i].label) == len && strncasecmp(solvers[i].label, label, len) == 0) return SOLVER_BIT(i);
+    }
+    return 0;
+}
+
+static solver_mask_t solver_named(const char * label) {
+    return label_mask(label, strlen(label));
+}
+
+// What plan_solvers needs, resolved by name once in get_solvers so planning a node never looks up a label
+static struct {
+    solver_mask_t transforms, classical, hash_lookup;
+    solver_mask_t hex, base64, base32, binary, octal, morse, dense, base;
+    solver_mask_t transpositions, symbol_shifts, keyed, cribbed, vigenere_crack;
+    analyzer_t * english, * hex_check, * base64_check, * ioc;
+} plan_table;
+
+static void plan_table_build(void) {
+    plan_table.transforms = group_mask(SOLVER_GROUP_TRANSFORM);
+    plan_table.classical = group_mask(SOLVER_GROUP_CLASSICAL);
+    plan_table.hash_lookup = solver_named("HASH_LOOKUP");
+    plan_table.hex = solver_named("HEX");
+    plan_table.base64 = solver_named("BASE64");
+    plan_table.base32 = solver_named("BASE32");
+    plan_table.binary = solver_named("BINARY");
+    plan_table.octal = solver_named("OCTAL");
+    plan_table.morse = solver_named("MORSE");
+    plan_table.dense = solver_named("BASE58") | solver_named("BASE85") | solver_named("BASE91") | solver_named("BASE");
+    plan_table.base = solver_named("BASE");
+    plan_table.transpositions = solver_named("RAILFENCE") | solver_named("COLUMNAR");
+    plan_table.symbol_shifts = solver_named("ROT") | solver_named("ROT47") | solver_named("BYTEMAP") | solver_named("REVERSE");
+    plan_table.keyed = solver_named("VIGENERE") | solver_named("XOR");
+    plan_table.cribbed = solver_named("VIGENERE_CRIB") | solver_named("XOR_CRIB");
+    plan_table.vigenere_crack = solver_named("VIGENERE_CRACK");
+    plan_table.english = analysis_find("ENGLISH");
+    plan_table.hex_check = analysis_find("HEX");
+    plan_table.base64_check = analysis_find("BASE64");
+    plan_table.ioc = analysis_find("IOC");
+}
+
+static float plan_check(const analyzer_t * analyzer, sds input, const analysis_profile_t * profile) {
+    return analyzer ? analyzer -> fn(input, profile).probability : 0.0f;
+}
+
+solver_t * get_solvers(const char * algorithms, size_t * count, solver_mask_t * mask, int * auto_plan) {
+    solver_mask_t all = solvers_count >= 64 ? ~(solver_mask_t) 0 : SOLVER_BIT(solvers_count) - 1;
     * count = solvers_count;
+    * mask = 0;
+    * auto_plan = 0;
+    plan_table_build();
+
+    const char * p = algorithms ? algorithms : "common";
+    while (* p) {
+        while (* p == ',' || isspace((unsigned char) * p)) p++;
+        if (! * p) break;
+        const char * start = p;
+        while (* p && * p != ',' && !isspace((unsigned char) * p)) p++;
+        size_t len = p - start;
+
+        solver_mask_t bits = 0;
+        if ((len == 6 && strncasecmp(start, "common", len) == 0) || (len == 3 && strncasecmp(start, "all", len) == 0)) {
+            bits = all;
+        } else if (len == 4 && strncasecmp(start, "auto", len) == 0) {
+            * auto_plan = 1;
+            continue;
+        } else {
+            for (size_t g = 0; g < sizeof(SOLVER_GROUP_NAMES) / sizeof(SOLVER_GROUP_NAMES[0]); g++) {
+                if (strlen(SOLVER_GROUP_NAMES[g].name) == len && strncasecmp(SOLVER_GROUP_NAMES[g].name, start, len) == 0) {
+                    bits = group_mask(SOLVER_GROUP_NAMES[g].group);
+                }
+            }
+            if (!bits) bits = label_mask(start, len);
+        }
+
+        if (!bits) {
+            fprintf(stderr, "ERROR: Unknown algorithm or group: %.*s\n", (int) len, start);
+            return NULL;
+        }
+        * mask |= bits;
+    }
+
+    // "auto" alone plans over every solver
+    if (* mask == 0) * mask = all;
     return solvers;
 }
+
+// Whether every non-whitespace byte of the node is in the allowed set
+static int profile_only(const analysis_profile_t * profile, const char * allowed) {
+    size_t hits = profile -> classes[CLASS_WHITESPACE];
+    unsigned char seen[256] = {0};
+    for (const unsigned char * c = (const unsigned char *) allowed; * c; c++) {
+        if (!seen[* c] && !isspace(* c)) hits += profile -> counts[* c];
+        seen[* c] = 1;
+    }
+    return hits == profile -> len;
+}
+
+solver_plan_t plan_solvers(sds input, int depth, solver_mask_t enabled, const keychain_t * keychain) {
+    solver_plan_t plan = { .mask = 0, .remaining_depth = AUTO_CIPHER_DEPTH, .encoded = 0 };
+
+    analysis_profile_t profile;
+    analysis_profile_build(input, & profile);
+    size_t len = profile.len;
+    if (len == 0) {
+        plan.remaining_depth = 0;
+        return plan;
+    }
+
+    // Transforms are cheap and gate themselves; digests are looked up whenever there is an index
+    plan.mask |= plan_table.transforms | plan_table.hash_lookup;
+
+    // Raw bytes only reach the solvers that handle them, the engine filters the rest
+    size_t text = profile.classes[CLASS_PRINTABLE] + profile.counts['\t'] + profile.counts['\r'] + profile.counts['\n'];
+    if (text < len) {
+        plan.mask = enabled;
+        plan.remaining_depth = AUTO_BINARY_DEPTH;
+        return plan;
+    }
+
+    // The ciphertext itself is always expanded, and short text reads as English too easily to stop on
+    if (depth > 0 && len >= AUTO_PLAINTEXT_MIN_LEN &&
+        plan_check(plan_table.english, input, & profile) >= AUTO_PLAINTEXT_SCORE) {
+        plan.mask = 0;
+        plan.remaining_depth = 0;
+        return plan;
+    }
+
+    // Encodings whose alphabet the node fits exactly; only these renew the depth budget
+    solver_mask_t encodings = 0;
+    if (plan_check(plan_table.hex_check, input, & profile) >= 1.0f || profile_only( & profile, "0123456789abcdefABCDEF")) encodings |= plan_table.hex;
+    if (plan_check(plan_table.base64_check, input, & profile) >= 1.0f) encodings |= plan_table.base64;
+    if (profile_only( & profile, "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789=")) encodings |= plan_table.base32;
+    if (profile_only( & profile, "01")) encodings |= plan_table.binary;
+    if (profile_only( & profile, "01234567")) encodings |= plan_table.octal;
+    if (profile_only( & profile, ".-_/|01")) encodings |= plan_table.morse;
+    if (profile_only( & profile, "0123456789")) encodings |= plan_table.base;
+    plan.mask |= encodings;
+    // Transpositions keep the alphabet, so an encoded layer may also have been scrambled
+    if (encodings) plan.mask |= plan_table.transpositions;
+
+    // Dense printable runs: the wide-alphabet encodings and radix numerals reject anything else quickly.
+    // Nearly any token fits them, so they are tried without counting as a recognized encoding
+    solver_mask_t guesses = 0;
+    if (profile.classes[CLASS_WHITESPACE] == 0) guesses = plan_table.dense & ~encodings;
+    plan.mask |= guesses;
+
+    // Letter-heavy text: classical ciphers, and key recovery once the IoC says polyalphabetic
+    size_t body = len - profile.classes[CLASS_WHITESPACE];
+    int letters = profile.classes[CLASS_ALPHA];
+    int lettered = body > 0 && letters >= AUTO_MIN_LETTER_SHARE * body;
+    if (lettered) {
+        plan.mask |= plan_table.classical;
+        // VIGENERE_CRACK is the only solver the IoC points at
+        if (plan_table.ioc && plan_table.ioc -> fn(input, & profile).solver) plan.mask |= plan_table.vigenere_crack;
+    } else {
+        // Symbol-heavy text (flags, codes) is still in reach of the cheap shifts and maps
+        plan.mask |= plan_table.symbol_shifts;
+    }
+
+    // Keyed ciphers only have something to work with when keys or a crib were given
+    if (keychain -> len > 0) plan.mask |= plan_table.keyed;
+    if (keychain -> crib) plan.mask |= plan_table.cribbed;
+
+    plan.encoded = encodings != 0;
+    plan.remaining_depth = encodings || guesses ? AUTO_ENCODING_DEPTH : AUTO_CIPHER_DEPTH;
+    plan.mask &= enabled;
+    return plan;
+}
@@ -1,11 +1,38 @@
 #ifndef SOLVER_REGISTRY_H
 #define SOLVER_REGISTRY_H
 
+#include <stdint.h>
 #include "../../lib/sds/sds.h"
+#include "../fitness.h"
+
+// Solver groups, selectable by name with -a
+#define SOLVER_GROUP_ENCODING 1  // "encodings": radix encodings, Morse, compression
+#define SOLVER_GROUP_CLASSICAL 2 // "classical": unkeyed substitutions and transpositions
+#define SOLVER_GROUP_KEYED 4     // "keyed": ciphers driven by -k/-K keys, a crib or key recovery
+#define SOLVER_GROUP_TRANSFORM 8 // "transforms": byte order and bit reshuffles
+
+// One bit per registry index, so a selection is decided once and tested per node with a mask
+typedef uint64_t solver_mask_t;
+#define SOLVER_BIT(i) ((solver_mask_t) 1 << (i))
+
+// A key read in place from argv (-k) or a memory-mapped keyfile (-K), not NUL-terminated
+typedef struct {
+	const char *data;
+	size_t len;
+} key_view_t;
+
+typedef struct hash_index hash_index_t;
 
 typedef struct {
 	int len;
-	sds *keys;
+	key_view_t *keys;
+	const char *crib; // -c known plaintext, NULL when not given
+	const hash_index_t *index; // -x precomputed digest index, NULL when not given
+
+	// Keyfile mappings the views point into, released by keychain_free
+	int map_count;
+	void **maps;
+	size_t *map_lens;
 } keychain_t;
 
 typedef struct {
@@ -15,6 +42,12 @@ typedef struct {
 	sds method;
 	sds data;
 	const char *last_solver;
+	int depth_limit; // -a auto: deepest this node's subtree may go, tightened by each node's plan
+
+	// Lazy outputs: data holds only a prefix, enough to score the node, and finish(pending)
+	// returns the whole output once the node is popped. Only read from lazy_outputs solvers.
+	sds pending;
+	sds (*finish)(sds pending);
 } solver_output_t;
 
 typedef struct {
@@ -30,12 +63,28 @@ typedef struct {
 
 	int prevent_consecutive;
 	int handles_non_printable;
-	
-	solver_result_t (*fn)(sds input, keychain_t *keychain);
+	int lazy_outputs;
+	int groups;
+
+	// stats: the input's order-independent statistics, gathered once per node and shared by every solver
+	solver_result_t (*fn)(sds input, keychain_t *keychain, const text_stats_t *stats);
 } solver_t;
 
 extern solver_t solvers[];
 extern size_t solvers_count;
-extern solver_t *get_solvers(const char *algorithms, size_t *count);
+
+// Parses -a into a selection mask over the registry: comma separated solver labels and group names
+// (encodings, classical, keyed, transforms), "common"/"all" for everything, and "auto" to plan per node.
+// Returns the registry, or NULL with a message for an unknown name.
+extern solver_t *get_solvers(const char *algorithms, size_t *count, solver_mask_t *mask, int *auto_plan);
+
+// -a auto: the solvers worth running on a node and how many more layers its output probably has
+typedef struct {
+	solver_mask_t mask;
+	int remaining_depth;
+	int encoded; // the node fits an encoding alphabet: its budget replaces the inherited one instead of narrowing it
+} solver_plan_t;
+
+extern solver_plan_t plan_solvers(sds input, int depth, solver_mask_t enabled, const keychain_t *keychain);
 
 #endif // SOLVER_REGISTRY_H
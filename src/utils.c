@@ -12,6 +12,20 @@ int verbose_flag = 0;
 
 #include <stdlib.h>
 
+#include <pthread.h>
+
+#include <unistd.h>
+
+#include <fcntl.h>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
 #include "../lib/sds/sds.h"
 
 #include "solvers/solver_registry.h"
@@ -179,6 +193,641 @@ unsigned char * base64_decode(const char * data, size_t input_len, size_t * outp
     return decoded_data;
 }
 
+// Reverse lookup for an encoding alphabet: byte -> digit value, RADIX_INVALID outside it.
+// Built on first use so every decoder can reject on the first foreign byte with one load.
+#define RADIX_INVALID 0xFF
+
+typedef struct {
+    const char * alphabet;
+    int fold_case;
+    int built;
+    unsigned char rev[256];
+} radix_table_t;
+
+static radix_table_t base32_table = { "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567", 1 };
+static radix_table_t base32hex_table = { "0123456789ABCDEFGHIJKLMNOPQRSTUV", 1 };
+static radix_table_t base58_table = { "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz", 0 };
+static radix_table_t base58_flickr_table = { "123456789abcdefghijkmnopqrstuvwxyzABCDEFGHJKLMNPQRSTUVWXYZ", 0 };
+static radix_table_t z85_table = { "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.-:+=^!/*?&<>()[]{}@%$#", 0 };
+static radix_table_t base91_table = { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789!#$%&()*+,./:;<=>?@[]^_`{|}~\"", 0 };
+
+static const unsigned char * radix_reverse(radix_table_t * table) {
+    if (!table -> built) {
+        memset(table -> rev, RADIX_INVALID, sizeof(table -> rev));
+        for (int i = 0; table -> alphabet[i]; i++) {
+            unsigned char c = (unsigned char) table -> alphabet[i];
+            table -> rev[c] = i;
+            if (table -> fold_case) table -> rev[tolower(c)] = i;
+        }
+        table -> built = 1;
+    }
+    return table -> rev;
+}
+
+unsigned char * base32_decode(const char * data, size_t input_len, int hex_alphabet, size_t * output_len) {
+    const unsigned char * rev = radix_reverse(hex_alphabet ? & base32hex_table : & base32_table);
+
+    while (input_len > 0 && data[input_len - 1] == '=') input_len--;
+    // 8 characters carry 5 bytes; a tail of 1, 3 or 6 characters cannot end on a byte boundary
+    size_t tail = input_len % 8;
+    if (input_len == 0 || tail == 1 || tail == 3 || tail == 6) return NULL;
+
+    unsigned char * decoded = malloc(input_len * 5 / 8 + 1);
+    if (!decoded) return NULL;
+
+    size_t j = 0;
+    for (size_t i = 0; i < input_len; i += 8) {
+        size_t group = input_len - i < 8 ? input_len - i : 8;
+        uint64_t word = 0;
+        for (size_t k = 0; k < 8; k++) {
+            unsigned char v = 0;
+            if (k < group) {
+                v = rev[(unsigned char) data[i + k]];
+                if (v == RADIX_INVALID) {
+                    free(decoded);
+                    return NULL;
+                }
+            }
+            word = (word << 5) | v;
+        }
+        size_t bytes = group * 5 / 8;
+        for (size_t k = 0; k < bytes; k++) decoded[j++] = (unsigned char) (word >> (32 - 8 * k));
+    }
+
+    * output_len = j;
+    return decoded;
+}
+
+unsigned char * base58_decode(const char * data, size_t input_len, int flickr_alphabet, size_t * output_len) {
+    const unsigned char * rev = radix_reverse(flickr_alphabet ? & base58_flickr_table : & base58_table);
+    if (input_len == 0) return NULL;
+
+    // Leading zero digits stand for leading zero bytes
+    size_t zeros = 0;
+    while (zeros < input_len && rev[(unsigned char) data[zeros]] == 0) zeros++;
+
+    // log(58) / log(2^32) < 0.19 limbs per digit; 5 digits fit one limb multiply (58^5 < 2^32)
+    size_t max_limbs = input_len * 19 / 100 + 2;
+    uint32_t * limbs = calloc(max_limbs, sizeof(uint32_t));
+    if (!limbs) return NULL;
+
+    size_t n = 0;
+    for (size_t i = zeros; i < input_len;) {
+        uint32_t mul = 1;
+        uint32_t add = 0;
+        for (int k = 0; k < 5 && i < input_len; k++, i++) {
+            unsigned char v = rev[(unsigned char) data[i]];
+            if (v == RADIX_INVALID) {
+                free(limbs);
+                return NULL;
+            }
+            mul *= 58;
+            add = add * 58 + v;
+        }
+        uint64_t carry = add;
+        for (size_t l = 0; l < n; l++) {
+            uint64_t t = (uint64_t) limbs[l] * mul + carry;
+            limbs[l] = (uint32_t) t;
+            carry = t >> 32;
+        }
+        if (carry) limbs[n++] = (uint32_t) carry;
+    }
+
+    unsigned char * decoded = malloc(zeros + n * 4 + 1);
+    if (!decoded) {
+        free(limbs);
+        return NULL;
+    }
+    size_t j = 0;
+    for (; j < zeros; j++) decoded[j] = 0;
+    int started = 0;
+    for (size_t l = n; l-- > 0;) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            unsigned char byte = (unsigned char) (limbs[l] >> shift);
+            if (!started && byte == 0) continue;
+            started = 1;
+            decoded[j++] = byte;
+        }
+    }
+    free(limbs);
+
+    * output_len = j;
+    return decoded;
+}
+
+// Shared by Ascii85 and Z85: 5 digits -> one big-endian 32-bit word, a short tail is padded with the top digit
+static unsigned char * base85_decode_groups(const char * data, size_t input_len, const unsigned char * rev, int zero_shortcut, size_t * output_len) {
+    unsigned char * decoded = malloc(input_len * (zero_shortcut ? 4 : 1) + 4);
+    if (!decoded) return NULL;
+
+    size_t j = 0;
+    size_t i = 0;
+    while (i < input_len) {
+        if (zero_shortcut && data[i] == 'z') {
+            memset(decoded + j, 0, 4);
+            j += 4;
+            i++;
+            continue;
+        }
+
+        size_t group = 0;
+        uint64_t word = 0;
+        for (; group < 5 && i < input_len; group++, i++) {
+            unsigned char v = rev[(unsigned char) data[i]];
+            if (v == RADIX_INVALID) {
+                free(decoded);
+                return NULL;
+            }
+            word = word * 85 + v;
+        }
+        if (group == 1) {
+            free(decoded);
+            return NULL;
+        }
+        for (size_t k = group; k < 5; k++) word = word * 85 + 84;
+        if (word > UINT32_MAX) {
+            free(decoded);
+            return NULL;
+        }
+        for (size_t k = 0; k < group - 1; k++) decoded[j++] = (unsigned char) (word >> (24 - 8 * k));
+    }
+
+    * output_len = j;
+    return decoded;
+}
+
+unsigned char * ascii85_decode(const char * data, size_t input_len, size_t * output_len) {
+    static unsigned char rev[256];
+    static int built = 0;
+    if (!built) {
+        memset(rev, RADIX_INVALID, sizeof(rev));
+        for (int c = '!'; c <= 'u'; c++) rev[c] = c - '!';
+        built = 1;
+    }
+
+    // Optional Adobe <~ ~> framing
+    if (input_len >= 4 && strncmp(data, "<~", 2) == 0 && strncmp(data + input_len - 2, "~>", 2) == 0) {
+        data += 2;
+        input_len -= 4;
+    }
+    if (input_len == 0) return NULL;
+    return base85_decode_groups(data, input_len, rev, 1, output_len);
+}
+
+unsigned char * z85_decode(const char * data, size_t input_len, size_t * output_len) {
+    // Z85 frames are always whole 5 character groups
+    if (input_len == 0 || input_len % 5 != 0) return NULL;
+    return base85_decode_groups(data, input_len, radix_reverse(& z85_table), 0, output_len);
+}
+
+unsigned char * base91_decode(const char * data, size_t input_len, size_t * output_len) {
+    const unsigned char * rev = radix_reverse(& base91_table);
+    if (input_len < 2) return NULL;
+
+    unsigned char * decoded = malloc(input_len * 14 / 8 + 2);
+    if (!decoded) return NULL;
+
+    // Character pairs carry 13 or 14 bits into a little-endian bit queue
+    size_t j = 0;
+    uint32_t queue = 0;
+    int bits = 0;
+    size_t i = 0;
+    for (; i + 1 < input_len; i += 2) {
+        unsigned char a = rev[(unsigned char) data[i]];
+        unsigned char b = rev[(unsigned char) data[i + 1]];
+        if (a == RADIX_INVALID || b == RADIX_INVALID) {
+            free(decoded);
+            return NULL;
+        }
+        uint32_t v = a + b * 91;
+        queue |= v << bits;
+        bits += (v & 8191) > 88 ? 13 : 14;
+        while (bits >= 8) {
+            decoded[j++] = (unsigned char) queue;
+            queue >>= 8;
+            bits -= 8;
+        }
+    }
+    if (i < input_len) {
+        unsigned char a = rev[(unsigned char) data[i]];
+        if (a == RADIX_INVALID) {
+            free(decoded);
+            return NULL;
+        }
+        decoded[j++] = (unsigned char) (queue | (uint32_t) a << bits);
+    }
+
+    * output_len = j;
+    return decoded;
+}
+
+// ==========================================
+// Keys
+// ==========================================
+
+int keychain_add(keychain_t * keychain, const char * data, size_t len) {
+    // Grow by doubling, wordlists add keys one line at a time
+    if ((keychain -> len & (keychain -> len - 1)) == 0) {
+        size_t cap = keychain -> len ? (size_t) keychain -> len * 2 : 16;
+        key_view_t * keys = realloc(keychain -> keys, sizeof(key_view_t) * cap);
+        if (!keys) return -1;
+        keychain -> keys = keys;
+    }
+    keychain -> keys[keychain -> len].data = data;
+    keychain -> keys[keychain -> len].len = len;
+    keychain -> len++;
+    return 0;
+}
+
+void * map_file(const char * path, size_t * len, int sequential) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER size;
+    void * data = NULL;
+    if (GetFileSizeEx(file, & size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        * len = (size_t) size.QuadPart;
+    }
+    CloseHandle(file);
+    return data;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void * data = NULL;
+    if (fstat(fd, & st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) data = NULL;
+        else madvise(data, st.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        * len = st.st_size;
+    }
+    close(fd);
+    return data;
+#endif
+}
+
+int keychain_map_file(keychain_t * keychain, const char * path) {
+    if (access(path, R_OK) != 0) return -1;
+
+    size_t len = 0;
+    const char * data = map_file(path, & len, 1);
+    if (!data) return len == 0 ? 0 : -1; // an empty file has no keys, a file with bytes has to map
+
+    void ** maps = realloc(keychain -> maps, sizeof(void *) * (keychain -> map_count + 1));
+    if (maps) keychain -> maps = maps;
+    size_t * map_lens = maps ? realloc(keychain -> map_lens, sizeof(size_t) * (keychain -> map_count + 1)) : NULL;
+    if (map_lens) keychain -> map_lens = map_lens;
+    if (!maps || !map_lens) {
+        unmap_file((void *) data, len);
+        return -1;
+    }
+    keychain -> maps[keychain -> map_count] = (void *) data;
+    keychain -> map_lens[keychain -> map_count] = len;
+    keychain -> map_count++;
+
+    const char * end = data + len;
+    const char * line = data;
+    while (line < end) {
+        const char * nl = memchr(line, '\n', end - line);
+        const char * stop = nl ? nl : end;
+        size_t key_len = stop - line;
+        if (key_len > 0 && line[key_len - 1] == '\r') key_len--;
+        if (key_len > 0 && keychain_add(keychain, line, key_len) != 0) return -1;
+        line = stop + 1;
+    }
+    return 0;
+}
+
+void unmap_file(void * data, size_t len) {
+#ifdef _WIN32
+    (void) len;
+    UnmapViewOfFile(data);
+#else
+    munmap(data, len);
+#endif
+}
+
+void keychain_free(keychain_t * keychain) {
+    for (int i = 0; i < keychain -> map_count; i++) {
+        unmap_file(keychain -> maps[i], keychain -> map_lens[i]);
+    }
+    free(keychain -> maps);
+    free(keychain -> map_lens);
+    free(keychain -> keys);
+    keychain -> maps = NULL;
+    keychain -> map_lens = NULL;
+    keychain -> keys = NULL;
+    keychain -> map_count = 0;
+    keychain -> len = 0;
+}
+
+// ==========================================
+// Decompression
+// ==========================================
+
+// Raw deflate (RFC 1951) decoder. Canonical Huffman codes are decoded a bit at a time from per-length
+// counts, which keeps the tables tiny and is plenty fast for the payload sizes the solver caps us at.
+#define INFLATE_MAX_BITS 15
+#define INFLATE_DONE 0
+#define INFLATE_FULL 1
+#define INFLATE_ERROR -1
+
+typedef struct {
+    const unsigned char * src;
+    size_t src_len;
+    size_t pos;
+    uint64_t bitbuf;
+    int bitcnt;
+
+    unsigned char * out;
+    size_t out_len;
+    size_t out_cap;
+    size_t max_out;
+} inflate_state_t;
+
+typedef struct {
+    short count[INFLATE_MAX_BITS + 1];
+    short symbol[288];
+} huffman_t;
+
+static const short LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const short LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const short DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const short DIST_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// -1 when the input runs out
+static int inflate_bits(inflate_state_t * s, int need) {
+    while (s -> bitcnt < need) {
+        if (s -> pos >= s -> src_len) return -1;
+        s -> bitbuf |= (uint64_t) s -> src[s -> pos++] << s -> bitcnt;
+        s -> bitcnt += 8;
+    }
+    int val = (int) (s -> bitbuf & ((1u << need) - 1));
+    s -> bitbuf >>= need;
+    s -> bitcnt -= need;
+    return val;
+}
+
+// 0 on success, -1 for an over-subscribed code. Incomplete codes are allowed, as in zlib, for single-symbol trees.
+static int huffman_build(huffman_t * h, const unsigned char * lengths, int n) {
+    short offs[INFLATE_MAX_BITS + 1];
+    memset(h -> count, 0, sizeof(h -> count));
+    for (int i = 0; i < n; i++) h -> count[lengths[i]]++;
+    h -> count[0] = 0;
+
+    int left = 1;
+    for (int len = 1; len <= INFLATE_MAX_BITS; len++) {
+        left <<= 1;
+        left -= h -> count[len];
+        if (left < 0) return -1;
+    }
+
+    offs[1] = 0;
+    for (int len = 1; len < INFLATE_MAX_BITS; len++) offs[len + 1] = offs[len] + h -> count[len];
+    for (int i = 0; i < n; i++) {
+        if (lengths[i]) h -> symbol[offs[lengths[i]]++] = i;
+    }
+    return 0;
+}
+
+static int huffman_decode(inflate_state_t * s, const huffman_t * h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= INFLATE_MAX_BITS; len++) {
+        int bit = inflate_bits(s, 1);
+        if (bit < 0) return -1;
+        code |= bit;
+        int count = h -> count[len];
+        if (code - count < first) return h -> symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static int inflate_put(inflate_state_t * s, unsigned char byte) {
+    if (s -> out_len >= s -> max_out) return INFLATE_FULL;
+    if (s -> out_len == s -> out_cap) {
+        size_t cap = s -> out_cap ? s -> out_cap * 2 : 4096;
+        if (cap > s -> max_out) cap = s -> max_out;
+        unsigned char * grown = realloc(s -> out, cap);
+        if (!grown) return INFLATE_ERROR;
+        s -> out = grown;
+        s -> out_cap = cap;
+    }
+    s -> out[s -> out_len++] = byte;
+    return INFLATE_DONE;
+}
+
+static int inflate_stored(inflate_state_t * s) {
+    s -> bitbuf = 0;
+    s -> bitcnt = 0;
+    if (s -> pos + 4 > s -> src_len) return INFLATE_ERROR;
+    unsigned len = s -> src[s -> pos] | (s -> src[s -> pos + 1] << 8);
+    unsigned nlen = s -> src[s -> pos + 2] | (s -> src[s -> pos + 3] << 8);
+    s -> pos += 4;
+    if (len != (~nlen & 0xFFFF)) return INFLATE_ERROR;
+    if (s -> pos + len > s -> src_len) return INFLATE_ERROR;
+    for (unsigned i = 0; i < len; i++) {
+        int status = inflate_put(s, s -> src[s -> pos++]);
+        if (status != INFLATE_DONE) return status;
+    }
+    return INFLATE_DONE;
+}
+
+static int inflate_codes(inflate_state_t * s, const huffman_t * lencode, const huffman_t * distcode) {
+    for (;;) {
+        int symbol = huffman_decode(s, lencode);
+        if (symbol < 0) return INFLATE_ERROR;
+        if (symbol < 256) {
+            int status = inflate_put(s, (unsigned char) symbol);
+            if (status != INFLATE_DONE) return status;
+            continue;
+        }
+        if (symbol == 256) return INFLATE_DONE;
+
+        symbol -= 257;
+        if (symbol >= 29) return INFLATE_ERROR;
+        int extra = inflate_bits(s, LENGTH_EXTRA[symbol]);
+        if (extra < 0) return INFLATE_ERROR;
+        int len = LENGTH_BASE[symbol] + extra;
+
+        symbol = huffman_decode(s, distcode);
+        if (symbol < 0 || symbol >= 30) return INFLATE_ERROR;
+        extra = inflate_bits(s, DIST_EXTRA[symbol]);
+        if (extra < 0) return INFLATE_ERROR;
+        size_t dist = DIST_BASE[symbol] + extra;
+        if (dist > s -> out_len) return INFLATE_ERROR;
+
+        while (len--) {
+            int status = inflate_put(s, s -> out[s -> out_len - dist]);
+            if (status != INFLATE_DONE) return status;
+        }
+    }
+}
+
+static huffman_t fixed_lencode, fixed_distcode;
+static int fixed_built = 0;
+
+static int inflate_fixed(inflate_state_t * s) {
+    if (!fixed_built) {
+        unsigned char lengths[288];
+        int i = 0;
+        for (; i < 144; i++) lengths[i] = 8;
+        for (; i < 256; i++) lengths[i] = 9;
+        for (; i < 280; i++) lengths[i] = 7;
+        for (; i < 288; i++) lengths[i] = 8;
+        huffman_build( & fixed_lencode, lengths, 288);
+        for (i = 0; i < 30; i++) lengths[i] = 5;
+        huffman_build( & fixed_distcode, lengths, 30);
+        fixed_built = 1;
+    }
+    return inflate_codes(s, & fixed_lencode, & fixed_distcode);
+}
+
+static int inflate_dynamic(inflate_state_t * s) {
+    static const unsigned char order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    unsigned char lengths[320];
+    huffman_t lencode, distcode;
+
+    int nlen = inflate_bits(s, 5);
+    int ndist = inflate_bits(s, 5);
+    int ncode = inflate_bits(s, 4);
+    if (nlen < 0 || ndist < 0 || ncode < 0) return INFLATE_ERROR;
+    nlen += 257;
+    ndist += 1;
+    ncode += 4;
+    if (nlen > 286 || ndist > 30) return INFLATE_ERROR;
+
+    memset(lengths, 0, 19);
+    for (int i = 0; i < ncode; i++) {
+        int len = inflate_bits(s, 3);
+        if (len < 0) return INFLATE_ERROR;
+        lengths[order[i]] = len;
+    }
+    if (huffman_build( & lencode, lengths, 19) != 0) return INFLATE_ERROR;
+
+    int index = 0;
+    while (index < nlen + ndist) {
+        int symbol = huffman_decode(s, & lencode);
+        if (symbol < 0) return INFLATE_ERROR;
+        if (symbol < 16) {
+            lengths[index++] = symbol;
+            continue;
+        }
+
+        int len = 0, repeat;
+        if (symbol == 16) {
+            if (index == 0) return INFLATE_ERROR;
+            len = lengths[index - 1];
+            repeat = inflate_bits(s, 2);
+            if (repeat < 0) return INFLATE_ERROR;
+            repeat += 3;
+        } else if (symbol == 17) {
+            repeat = inflate_bits(s, 3);
+            if (repeat < 0) return INFLATE_ERROR;
+            repeat += 3;
+        } else {
+            repeat = inflate_bits(s, 7);
+            if (repeat < 0) return INFLATE_ERROR;
+            repeat += 11;
+        }
+        if (index + repeat > nlen + ndist) return INFLATE_ERROR;
+        while (repeat--) lengths[index++] = len;
+    }
+    if (lengths[256] == 0) return INFLATE_ERROR;
+
+    if (huffman_build( & lencode, lengths, nlen) != 0) return INFLATE_ERROR;
+    if (huffman_build( & distcode, lengths + nlen, ndist) != 0) return INFLATE_ERROR;
+    return inflate_codes(s, & lencode, & distcode);
+}
+
+unsigned char * inflate_raw(const unsigned char * src, size_t src_len, size_t max_out, size_t * out_len, int * complete) {
+    inflate_state_t s = {
+        .src = src,
+        .src_len = src_len,
+        .max_out = max_out,
+    };
+
+    int last = 0;
+    int status = INFLATE_DONE;
+    while (!last && status == INFLATE_DONE) {
+        last = inflate_bits( & s, 1);
+        int type = inflate_bits( & s, 2);
+        if (last < 0 || type < 0) status = INFLATE_ERROR;
+        else if (type == 0) status = inflate_stored( & s);
+        else if (type == 1) status = inflate_fixed( & s);
+        else if (type == 2) status = inflate_dynamic( & s);
+        else status = INFLATE_ERROR;
+    }
+
+    if (status == INFLATE_ERROR) {
+        free(s.out);
+        return NULL;
+    }
+    * complete = status == INFLATE_DONE;
+    * out_len = s.out_len;
+    if (!s.out) s.out = malloc(1);
+    return s.out;
+}
+
+// ==========================================
+// Parallelism
+// ==========================================
+
+typedef struct {
+    int tasks;
+    int next;
+    parallel_fn fn;
+    void * ctx;
+} parallel_job_t;
+
+static void * parallel_worker(void * arg) {
+    parallel_job_t * job = arg;
+    int task;
+    while ((task = __atomic_fetch_add( & job -> next, 1, __ATOMIC_RELAXED)) < job -> tasks) {
+        job -> fn(task, job -> ctx);
+    }
+    return NULL;
+}
+
+int cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+}
+
+void parallel_for(int tasks, parallel_fn fn, void * ctx) {
+    parallel_job_t job = {
+        .tasks = tasks,
+        .next = 0,
+        .fn = fn,
+        .ctx = ctx
+    };
+
+    int workers = cpu_count();
+    if (workers > tasks) workers = tasks;
+
+    // The calling thread is a worker too, so a single CPU never pays for thread start-up
+    pthread_t * threads = workers > 1 ? malloc(sizeof(pthread_t) * (workers - 1)) : NULL;
+    int started = 0;
+    for (int i = 0; threads && i < workers - 1; i++) {
+        if (pthread_create( & threads[i], NULL, parallel_worker, & job) == 0) started++;
+    }
+
+    parallel_worker( & job);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
 // ==========================================
 // Main Logic Helpers (from main.c)
 // ==========================================
@@ -196,6 +845,8 @@ void free_result(solver_result_t * result) {
 void free_output(solver_output_t * output) {
     sdsfree(output -> method);
     sdsfree(output -> data);
+    sdsfree(output -> pending);
+    output -> pending = NULL;
 }
 
 void free_heap_output(void * key, void * value) {
@@ -206,13 +857,17 @@ void free_heap_output(void * key, void * value) {
     }
 }
 
+float output_priority(float cumulative_fitness, int depth) {
+    // Normalize by depth to prevent Depth-First Search behavior from dominating
+    return cumulative_fitness / (depth + 1.0f);
+}
+
 int output_compare_fn(void * output1, void * output2) {
     solver_output_t * o1 = (solver_output_t * ) output1;
     solver_output_t * o2 = (solver_output_t * ) output2;
 
-    // Normalize by depth to prevent Depth-First Search behavior from dominating
-    float score1 = o1 -> cumulative_fitness / (o1 -> depth + 1.0f);
-    float score2 = o2 -> cumulative_fitness / (o2 -> depth + 1.0f);
+    float score1 = output_priority(o1 -> cumulative_fitness, o1 -> depth);
+    float score2 = output_priority(o2 -> cumulative_fitness, o2 -> depth);
 
     if (score1 > score2) return -1; // o1 is "smaller" (top of heap/best)
     if (score1 < score2) return 1;
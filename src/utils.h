@@ -6,6 +6,7 @@
 #include <ctype.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 #include "../lib/sds/sds.h"
 #include "solvers/solver_registry.h" 
 
@@ -21,6 +22,46 @@ unsigned char *hex_to_bytes(const char *hex, int *out_len);
 unsigned char *binary_to_bytes(const char *bin, int *out_len);
 unsigned char *octal_to_bytes(const char *oct, int *out_len);
 unsigned char *base64_decode(const char *data, size_t input_len, size_t *output_len);
+// Return NULL on the first byte outside the alphabet or on a length the encoding cannot produce
+unsigned char *base32_decode(const char *data, size_t input_len, int hex_alphabet, size_t *output_len);
+unsigned char *base58_decode(const char *data, size_t input_len, int flickr_alphabet, size_t *output_len);
+unsigned char *ascii85_decode(const char *data, size_t input_len, size_t *output_len);
+unsigned char *z85_decode(const char *data, size_t input_len, size_t *output_len);
+unsigned char *base91_decode(const char *data, size_t input_len, size_t *output_len);
+
+// Keys
+// Adds one key view, the bytes must outlive the keychain. Returns -1 when out of memory.
+int keychain_add(keychain_t *keychain, const char *data, size_t len);
+// Memory-maps a keyfile and adds every non-empty line as a view into the mapping.
+// Returns -1 if it cannot be opened or mapped, or when out of memory.
+int keychain_map_file(keychain_t *keychain, const char *path);
+void keychain_free(keychain_t *keychain);
+
+// Files
+// Read-only mapping of the whole file, NULL for an empty or unreadable one. sequential hints a front-to-back scan.
+// *len is the file size whenever it could be read, so NULL with a non-zero *len means the mapping itself failed.
+void *map_file(const char *path, size_t *len, int sequential);
+void unmap_file(void *data, size_t len);
+
+// Decompression
+// Inflates a raw deflate stream into at most max_out bytes. *complete is 0 when it stopped at max_out.
+// Returns NULL on a malformed stream.
+unsigned char *inflate_raw(const unsigned char *src, size_t src_len, size_t max_out, size_t *out_len, int *complete);
+
+// Parallelism
+// Runs fn(task, ctx) for every task in [0, tasks) across one worker per CPU and returns when all are done.
+typedef void (*parallel_fn)(int task, void *ctx);
+int cpu_count(void);
+void parallel_for(int tasks, parallel_fn fn, void *ctx);
+
+// Small deterministic PRNG (xorshift32) for randomised searches, state must be non-zero
+static inline uint32_t rng_next(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
 
 // Fitness / Scoring
 float fitness_heuristic(sds data);
@@ -29,6 +70,8 @@ float fitness_heuristic(sds data);
 void free_result(solver_result_t *result);
 void free_output(solver_output_t *output);
 void free_heap_output(void *key, void *value);
+// Search priority of a node: its cumulative fitness averaged over the path. Higher is expanded first.
+float output_priority(float cumulative_fitness, int depth);
 int output_compare_fn(void *output1, void *output2);
 
 #endif // UTILS_H